@@ -0,0 +1,36 @@
+#pragma once
+#include <chrono>
+
+/*
+ * Each benchmark is a subcommand of SimpleDrawBench and receives the
+ * arguments that follow its name.  It returns the process exit code.
+ */
+int ShaderLoadBench(int argc, char** argv);
+int SceneBench(int argc, char** argv);
+int CompareBench(int argc, char** argv);
+int JobsBench(int argc, char** argv);
+int QueueBench(int argc, char** argv);
+int PoolBench(int argc, char** argv);
+int SpirvBench(int argc, char** argv);
+
+struct GLFWwindow;
+
+/* glfwInit(), on the null platform when there is no display; false if GLFW cannot start */
+bool InitBenchPlatform();
+/* a hidden window with a current OpenGL 4.6 context and GLEW loaded, or nullptr */
+GLFWwindow* CreateBenchContext();
+void DestroyBenchContext(GLFWwindow* window);
+
+/* wall-clock stopwatch used by all benchmarks */
+class BenchTimer
+{
+private:
+	std::chrono::steady_clock::time_point m_Start;
+public:
+	BenchTimer() : m_Start(std::chrono::steady_clock::now()) {}
+	void Reset() { m_Start = std::chrono::steady_clock::now(); }
+	double ElapsedMs() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+	}
+};
@@ -0,0 +1,38 @@
+/*
+ * GL context for the benchmarks that draw.  Nothing is shown: the window stays
+ * hidden, and without a display GLFW's null platform provides an EGL context
+ * (OSMesa as fallback), the same way SimpleDraw --benchmark does.
+ */
+#include "Bench.h"
+#include "Renderer.h"
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+bool InitBenchPlatform() {
+	if (!HasDisplay() && glfwPlatformSupported(GLFW_PLATFORM_NULL))
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+	return glfwInit() == GLFW_TRUE;
+}
+
+GLFWwindow* CreateBenchContext() {
+	if (!InitBenchPlatform())
+		return nullptr;
+
+	GLFWwindow* window = CreateGlWindow(640, 480, false);
+	if (!window) {
+		std::cout << "Error:  no OpenGL 4.6 context for the benchmark" << std::endl;
+		glfwTerminate();
+		return nullptr;
+	}
+	glfwSwapInterval(0);
+
+	std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+	std::cout << "OpenGL Renderer: " << glGetString(GL_RENDERER) << std::endl;
+	return window;
+}
+
+void DestroyBenchContext(GLFWwindow* window) {
+	glfwDestroyWindow(window);
+	glfwTerminate();
+}
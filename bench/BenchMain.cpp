@@ -0,0 +1,40 @@
+/*
+	SimpleDrawBench runs the performance benchmarks of SimpleDraw.
+	Usage: SimpleDrawBench <benchmark> [arguments]
+*/
+#include "Bench.h"
+
+#include <cstring>
+#include <iostream>
+
+struct BenchEntry
+{
+	const char* name;
+	int (*run)(int argc, char** argv);
+	const char* usage;
+};
+
+static const BenchEntry benches[] =
+{
+	{ "shaderload", ShaderLoadBench, "shaderload [files=300] [dir=bench_shaders]" },
+	{ "scene", SceneBench, "scene [maxPrimitives=1e7] [frames=10] [seed=1] [out=scene_results] [--perf]" },
+	{ "jobs", JobsBench, "jobs [primitives=1e7] [repeats=5] [maxWorkers=hardware threads] [out=jobs_results]" },
+	{ "queue", QueueBench, "queue [producers=4] [commands=1e6] [drainUs=1000] [out=queue_results]" },
+	{ "spirv", SpirvBench, "spirv [programs=50] [dir=res/shaders/spirv]" },
+	{ "pool", PoolBench, "pool [charts=1000] [maxWorkers=hardware threads] [size=256] [out=pool_results]" },
+	{ "compare", CompareBench, "compare <baseline.csv> <results.csv> [tolerance%=10]" },
+};
+
+int main(int argc, char** argv) {
+	if (argc > 1) {
+		for (const BenchEntry& bench : benches) {
+			if (strcmp(argv[1], bench.name) == 0)
+				return bench.run(argc - 2, argv + 2);
+		}
+	}
+
+	std::cout << "Usage: SimpleDrawBench <benchmark> [arguments]" << std::endl;
+	for (const BenchEntry& bench : benches)
+		std::cout << "  " << bench.usage << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+/*
+ * Compares a `scene` result CSV against a baseline CSV and flags every path and
+ * size whose throughput dropped by more than the tolerance.  Exits with failure
+ * when anything regressed, so it can gate a CI job.
+ */
+#include "Bench.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::pair<std::string, unsigned long long> ResultKey;  // path, primitives
+
+/* primitives_per_sec by path and size; columns are found by header name */
+static bool readResults(const std::string& filepath, std::map<ResultKey, double>& results) {
+	std::ifstream stream(filepath);
+	std::string line;
+	if (!stream || !getline(stream, line)) {
+		std::cout << "compare: cannot read " << filepath << std::endl;
+		return false;
+	}
+
+	auto split = [](const std::string& text) {
+		std::vector<std::string> fields;
+		std::stringstream ss(text);
+		std::string field;
+		while (getline(ss, field, ','))
+			fields.push_back(field);
+		return fields;
+	};
+
+	std::vector<std::string> header = split(line);
+	int path = -1, primitives = -1, throughput = -1;
+	for (int i = 0; i < (int)header.size(); i++) {
+		if (header[i] == "path") path = i;
+		else if (header[i] == "primitives") primitives = i;
+		else if (header[i] == "primitives_per_sec") throughput = i;
+	}
+	if (path < 0 || primitives < 0 || throughput < 0) {
+		std::cout << "compare: " << filepath << " is not a scene result file" << std::endl;
+		return false;
+	}
+
+	while (getline(stream, line)) {
+		std::vector<std::string> fields = split(line);
+		if ((int)fields.size() < (int)header.size())
+			continue;
+		results[{ fields[path], strtoull(fields[primitives].c_str(), nullptr, 10) }] = atof(fields[throughput].c_str());
+	}
+	return true;
+}
+
+int CompareBench(int argc, char** argv) {
+	if (argc < 2) {
+		std::cout << "compare: needs a baseline and a result file" << std::endl;
+		return EXIT_FAILURE;
+	}
+	double tolerance = argc > 2 ? atof(argv[2]) : 10.0;
+
+	std::map<ResultKey, double> baseline, current;
+	if (!readResults(argv[0], baseline) || !readResults(argv[1], current))
+		return EXIT_FAILURE;
+
+	int regressions = 0;
+	for (const auto& entry : current) {
+		auto base = baseline.find(entry.first);
+		std::cout << "  " << entry.first.first << " x" << entry.first.second << ": ";
+		if (base == baseline.end() || base->second <= 0.0) {
+			std::cout << entry.second << " primitives/s (no baseline)" << std::endl;
+			continue;
+		}
+
+		double change = (entry.second - base->second) / base->second * 100.0;
+		bool regressed = change < -tolerance;
+		regressions += regressed;
+		std::cout << base->second << " -> " << entry.second << " primitives/s (" << (change >= 0.0 ? "+" : "")
+			<< change << "%)" << (regressed ? "  REGRESSION" : "") << std::endl;
+	}
+	for (const auto& entry : baseline) {
+		if (current.find(entry.first) == current.end())
+			std::cout << "  " << entry.first.first << " x" << entry.first.second << ": missing from " << argv[1] << std::endl;
+	}
+
+	std::cout << "compare: " << regressions << " regression(s) beyond " << tolerance << "%" << std::endl;
+	return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+/*
+ * Scaling of the job system from one worker up to every hardware thread.
+ * Each workload runs `repeats` times per worker count and the median is kept:
+ *   generate_soup, generate_mesh  SceneGenerator with a JobSystem
+ *   cull                          SceneStore::Cull over primitives/10 entities
+ *   graph                         a task graph: per task generate -> bounds, all -> reduce
+ * Every workload also produces a checksum, which has to match the one-worker
+ * run.  Results are written to <out>.csv and <out>.json.
+ */
+#include "Bench.h"
+#include "JobSystem.h"
+#include "SceneGenerator.h"
+#include "SceneStore.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct JobsResult
+{
+	const char* Workload;
+	unsigned int Workers;
+	double Ms;
+	double Speedup;      // against one worker
+	double Efficiency;   // speedup per worker
+};
+
+struct Workload
+{
+	const char* Name;
+	double (*Run)(JobSystem& jobs, unsigned long long primitives);  // returns a checksum
+};
+
+static double sumVertices(const GeneratedScene& scene) {
+	double sum = 0.0;
+	for (size_t i = 0; i < scene.Vertices.size(); i += 97)
+		sum += scene.Vertices[i];
+	return sum + scene.Indices.size();
+}
+
+static double generateSoup(JobSystem& jobs, unsigned long long primitives) {
+	return sumVertices(SceneGenerator::TriangleSoup(primitives, 1, &jobs));
+}
+
+static double generateMesh(JobSystem& jobs, unsigned long long primitives) {
+	return sumVertices(SceneGenerator::TriangleMesh(primitives, 1, &jobs));
+}
+
+/* built once and shared by all worker counts; Cull() only rewrites the visible flags */
+static SceneStore* cullStore = nullptr;
+
+static double cull(JobSystem& jobs, unsigned long long) {
+	return cullStore->Cull(-0.5f, -0.5f, 0.5f, 0.5f, &jobs);
+}
+
+/* task -> generate -> bounds; reduce waits for every bounds job */
+static double graph(JobSystem& jobs, unsigned long long primitives) {
+	struct Bounds { float MinX, MinY, MaxX, MaxY; };
+	/* a task covers whole generator chunks; like ParallelFor, at most a quarter of
+	   the job ring is used, so any primitive count fits in one graph */
+	const unsigned long long chunk = SceneGenerator::CHUNK;
+	const unsigned int MAX_TASKS = JobSystem::MAX_JOBS / 4;
+	unsigned long long chunks = (primitives + chunk - 1) / chunk;
+	unsigned long long chunksPerTask = (chunks + MAX_TASKS - 1) / MAX_TASKS;
+	unsigned int tasks = (unsigned int)((chunks + chunksPerTask - 1) / chunksPerTask);
+	std::vector<float> vertices(primitives * 2);
+	std::vector<Bounds> bounds(tasks);
+	Bounds total = {};
+
+	float* v = vertices.data();
+	Bounds* b = bounds.data();
+	Bounds* result = &total;
+	JobSystem::Job* reduce = jobs.Create([b, tasks, result] {
+		Bounds all = b[0];
+		for (unsigned int i = 1; i < tasks; i++) {
+			all.MinX = std::min(all.MinX, b[i].MinX);
+			all.MinY = std::min(all.MinY, b[i].MinY);
+			all.MaxX = std::max(all.MaxX, b[i].MaxX);
+			all.MaxY = std::max(all.MaxY, b[i].MaxY);
+		}
+		*result = all;
+	});
+
+	std::vector<JobSystem::Job*> generated(tasks);
+	for (unsigned int t = 0; t < tasks; t++) {
+		unsigned long long firstChunk = t * chunksPerTask, lastChunk = std::min(chunks, firstChunk + chunksPerTask);
+		unsigned long long first = firstChunk * chunk, last = std::min(primitives, lastChunk * chunk);
+		JobSystem::Job* generate = jobs.Create([v, firstChunk, lastChunk, primitives] {
+			for (unsigned long long c = firstChunk; c < lastChunk; c++) {
+				SceneRandom random = SceneRandom::ForChunk(1, c);
+				unsigned long long end = std::min(primitives, (c + 1) * SceneGenerator::CHUNK);
+				for (unsigned long long i = c * SceneGenerator::CHUNK * 2; i < end * 2; i++)
+					v[i] = random.Range(-1.0f, 1.0f);
+			}
+		});
+		JobSystem::Job* measure = jobs.Create([v, b, t, first, last] {
+			Bounds bounds = { v[first * 2], v[first * 2 + 1], v[first * 2], v[first * 2 + 1] };
+			for (unsigned long long i = first; i < last; i++) {
+				bounds.MinX = std::min(bounds.MinX, v[i * 2]);
+				bounds.MaxX = std::max(bounds.MaxX, v[i * 2]);
+				bounds.MinY = std::min(bounds.MinY, v[i * 2 + 1]);
+				bounds.MaxY = std::max(bounds.MaxY, v[i * 2 + 1]);
+			}
+			b[t] = bounds;
+		});
+		jobs.AddDependency(measure, generate);
+		jobs.AddDependency(reduce, measure);
+		jobs.Run(measure);
+		generated[t] = generate;
+	}
+	/* everything is wired before the first job starts */
+	jobs.Run(reduce);
+	for (JobSystem::Job* generate : generated)
+		jobs.Run(generate);
+	jobs.Wait(reduce);
+	return (double)total.MinX + total.MinY + total.MaxX + total.MaxY;
+}
+
+static const Workload workloads[] =
+{
+	{ "generate_soup", generateSoup },
+	{ "generate_mesh", generateMesh },
+	{ "cull",          cull },
+	{ "graph",         graph },
+};
+
+static bool writeResults(const std::string& out, const std::vector<JobsResult>& results, unsigned long long primitives) {
+	std::ofstream csv(out + ".csv");
+	std::ofstream json(out + ".json");
+	if (!csv || !json) {
+		std::cout << "jobs: cannot write " << out << ".csv/.json" << std::endl;
+		return false;
+	}
+
+	csv << "workload,workers,ms,speedup,efficiency\n";
+	json << "{\n  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n  \"primitives\": " << primitives
+		<< ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const JobsResult& r = results[i];
+		csv << r.Workload << ',' << r.Workers << ',' << r.Ms << ',' << r.Speedup << ',' << r.Efficiency << '\n';
+		json << "    { \"workload\": \"" << r.Workload << "\", \"workers\": " << r.Workers << ", \"ms\": " << r.Ms
+			<< ", \"speedup\": " << r.Speedup << ", \"efficiency\": " << r.Efficiency << " }"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+
+	std::cout << "jobs: results written to " << out << ".csv and " << out << ".json" << std::endl;
+	return true;
+}
+
+int JobsBench(int argc, char** argv) {
+	unsigned long long primitives = argc > 0 ? (unsigned long long)atof(argv[0]) : 10000000ull;
+	int repeats = argc > 1 ? atoi(argv[1]) : 5;
+	unsigned int maxWorkers = argc > 2 ? (unsigned int)atoi(argv[2]) : std::thread::hardware_concurrency();
+	std::string out = argc > 3 ? argv[3] : "jobs_results";
+	if (primitives < 1000 || repeats <= 0 || maxWorkers == 0) {
+		std::cout << "jobs: needs at least 1000 primitives, one repeat and one worker" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<unsigned int> workerCounts;
+	for (unsigned int workers = 1; workers < maxWorkers; workers *= 2)
+		workerCounts.push_back(workers);
+	workerCounts.push_back(maxWorkers);
+
+	/* cull entities are small random rectangles; only their bounds matter */
+	unsigned int entities = (unsigned int)(primitives / 10);
+	SceneStore store(entities);
+	SceneRandom random(1);
+	for (unsigned int i = 0; i < entities; i++) {
+		float x = random.Range(-1.0f, 1.0f), y = random.Range(-1.0f, 1.0f);
+		float corners[] = { x, y, x + 0.01f, y + 0.01f };
+		store.Add(SceneStore::KIND_POINTS, corners, 2, 2, {});
+	}
+	cullStore = &store;
+
+	std::cout << "jobs: " << primitives << " primitives, " << entities << " cull entities, up to " << maxWorkers
+		<< " workers (" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+
+	bool consistent = true;
+	std::vector<JobsResult> results;
+	for (const Workload& workload : workloads) {
+		double baseMs = 0.0, baseChecksum = 0.0;
+		for (unsigned int workers : workerCounts) {
+			JobSystem jobs(workers);
+			double checksum = 0.0;
+			std::vector<double> times;
+			for (int i = 0; i < repeats; i++) {
+				BenchTimer timer;
+				checksum = workload.Run(jobs, primitives);
+				times.push_back(timer.ElapsedMs());
+			}
+			std::sort(times.begin(), times.end());
+			double ms = times[times.size() / 2];
+
+			if (workers == 1) {
+				baseMs = ms;
+				baseChecksum = checksum;
+			}
+			else if (checksum != baseChecksum) {
+				std::cout << "jobs: " << workload.Name << " with " << workers << " workers gave checksum " << checksum
+					<< ", one worker gave " << baseChecksum << std::endl;
+				consistent = false;
+			}
+
+			JobsResult r = { workload.Name, workers, ms, baseMs / ms, baseMs / ms / workers };
+			std::cout << "  " << r.Workload << " x" << r.Workers << ": " << r.Ms << " ms, speedup " << r.Speedup
+				<< ", efficiency " << r.Efficiency << std::endl;
+			results.push_back(r);
+		}
+	}
+	cullStore = nullptr;
+
+	if (!writeResults(out, results, primitives))
+		return EXIT_FAILURE;
+	return consistent ? EXIT_SUCCESS : EXIT_FAILURE;
+}
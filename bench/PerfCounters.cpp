@@ -0,0 +1,153 @@
+#include "PerfCounters.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounters::PerfCounters()
+	: m_Opened(0)
+{
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_Fds[i] = -1;
+		m_Slots[i] = -1;
+		m_Totals[i] = 0;
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+	for (int fd : m_Fds)
+		if (fd >= 0)
+			close(fd);
+#endif
+}
+
+const char* PerfCounters::Name(Counter counter)
+{
+	switch (counter) {
+		case CYCLES:        return "cycles";
+		case INSTRUCTIONS:  return "instructions";
+		case CACHE_MISSES:  return "cache_misses";
+		case BRANCH_MISSES: return "branch_misses";
+		default:            return "unknown";
+	}
+}
+
+#ifdef __linux__
+
+/* group read layout with PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING */
+struct GroupRead
+{
+	uint64_t Count;
+	uint64_t TimeEnabled;
+	uint64_t TimeRunning;
+	uint64_t Values[PerfCounters::COUNTER_COUNT];
+};
+
+static int leaderFd(const int* fds, const int* slots)
+{
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+		if (slots[i] == 0)
+			return fds[i];
+	return -1;
+}
+
+bool PerfCounters::Open()
+{
+	static const uint64_t configs[COUNTER_COUNT] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+
+	int error = 0;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.disabled = m_Opened == 0;  // only the leader; members follow it
+		attr.exclude_kernel = 1;        // allowed with the default perf_event_paranoid of 2
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leaderFd(m_Fds, m_Slots), 0);
+		if (fd < 0)
+		{
+			error = errno;
+			continue;
+		}
+		m_Fds[i] = fd;
+		m_Slots[i] = m_Opened++;
+	}
+
+	if (!m_Opened)
+		std::cout << "Warning:  perf_event_open failed (" << strerror(error)
+			<< "); check /proc/sys/kernel/perf_event_paranoid" << std::endl;
+	return m_Opened > 0;
+}
+
+void PerfCounters::Start()
+{
+	int leader = leaderFd(m_Fds, m_Slots);
+	if (leader < 0)
+		return;
+	ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::Stop()
+{
+	int leader = leaderFd(m_Fds, m_Slots);
+	if (leader < 0)
+		return;
+	ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	GroupRead data;
+	if (read(leader, &data, sizeof(data)) < (ssize_t)(3 * sizeof(uint64_t)))
+		return;
+
+	/* scale up if the kernel had to multiplex the group off the PMU for part of the time */
+	double scale = data.TimeRunning > 0 && data.TimeRunning < data.TimeEnabled
+		? (double)data.TimeEnabled / data.TimeRunning : 1.0;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+		if (m_Slots[i] >= 0 && (uint64_t)m_Slots[i] < data.Count)
+			m_Totals[i] += (uint64_t)(data.Values[m_Slots[i]] * scale);
+}
+
+#else
+
+bool PerfCounters::Open()
+{
+	std::cout << "Warning:  hardware counters need Linux perf_event_open" << std::endl;
+	return false;
+}
+
+void PerfCounters::Start()
+{
+}
+
+void PerfCounters::Stop()
+{
+}
+
+#endif
+
+void PerfCounters::Reset()
+{
+	for (uint64_t& total : m_Totals)
+		total = 0;
+}
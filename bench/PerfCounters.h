@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+/*
+ * Hardware counters of the calling thread, user space only, read through Linux
+ * perf_event_open.  Start()/Stop() bracket a measured region and add to the
+ * totals.  The counters run as one group, so they cover exactly the same
+ * instructions; a counter the CPU or VM does not offer is left out.  On other
+ * systems Open() fails and the rest is a no-op.
+ */
+class PerfCounters
+{
+public:
+	enum Counter
+	{
+		CYCLES,
+		INSTRUCTIONS,
+		CACHE_MISSES,
+		BRANCH_MISSES,
+		COUNTER_COUNT
+	};
+private:
+	int m_Fds[COUNTER_COUNT];        // -1 when the counter is not available
+	int m_Slots[COUNTER_COUNT];      // position of each counter in a group read
+	int m_Opened;
+	uint64_t m_Totals[COUNTER_COUNT];
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	/* reports why when no counter could be opened */
+	bool Open();
+	bool IsOpen() const { return m_Opened > 0; }
+	bool Has(Counter counter) const { return m_Fds[counter] >= 0; }
+
+	void Start();
+	void Stop();
+	void Reset();
+	uint64_t Total(Counter counter) const { return m_Totals[counter]; }
+
+	static const char* Name(Counter counter);
+};
@@ -0,0 +1,155 @@
+/*
+ * Batch chart rendering through RenderPool with 1, 2, 4, ... workers, each with
+ * its own context.  Every run draws the same `charts` seeded random series of
+ * 32 to 256 points at size x size pixels and writes them to <out>_images/.
+ * Reported per worker count: charts per second, speedup and efficiency against
+ * one worker, how often the producer found the queue full, and each worker's
+ * share of the charts.  The image checksum has to match the one-worker run.
+ * Results go to <out>.csv and <out>.json.
+ *
+ * Under Mesa's llvmpipe every context rasterizes with its own thread pool; run
+ * with LP_NUM_THREADS=0 so the workers are the only parallelism.
+ */
+#include "Bench.h"
+#include "RenderPool.h"
+#include "SceneGenerator.h"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PoolResult
+{
+	unsigned int Workers;
+	double Ms;
+	double ChartsPerSec;
+	double Speedup;      // against one worker
+	double Efficiency;   // speedup per worker
+	uint64_t Waited;     // submits that found the queue full
+	uint64_t MinJobs;    // fewest and most charts a worker drew
+	uint64_t MaxJobs;
+};
+
+static ChartJob makeChart(unsigned int index, const std::string& dir) {
+	SceneRandom random = SceneRandom::ForChunk(1, index);
+	ChartJob job;
+	job.OutPath = dir + "/chart_" + std::to_string(index) + ".ppm";
+	job.Values.resize(32 + (size_t)(random.Next() % (RenderPool::MAX_POINTS - 31)));
+	float value = random.Range(0.2f, 0.8f);
+	for (float& v : job.Values) {
+		value = std::min(std::max(value + random.Range(-0.08f, 0.08f), 0.0f), 1.0f);
+		v = value;
+	}
+	job.Color = { { random.Range(0.3f, 1.0f), random.Range(0.3f, 1.0f), random.Range(0.3f, 1.0f), 1.0f } };
+	return job;
+}
+
+static bool writeResults(const std::string& out, const std::vector<PoolResult>& results, unsigned int charts, int size) {
+	std::ofstream csv(out + ".csv");
+	std::ofstream json(out + ".json");
+	if (!csv || !json) {
+		std::cout << "pool: cannot write " << out << ".csv/.json" << std::endl;
+		return false;
+	}
+
+	csv << "workers,charts,ms,charts_per_sec,speedup,efficiency,queue_full,min_worker_charts,max_worker_charts\n";
+	json << "{\n  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n  \"charts\": " << charts
+		<< ",\n  \"size\": " << size << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const PoolResult& r = results[i];
+		csv << r.Workers << ',' << charts << ',' << r.Ms << ',' << r.ChartsPerSec << ',' << r.Speedup << ',' << r.Efficiency
+			<< ',' << r.Waited << ',' << r.MinJobs << ',' << r.MaxJobs << '\n';
+		json << "    { \"workers\": " << r.Workers << ", \"ms\": " << r.Ms << ", \"charts_per_sec\": " << r.ChartsPerSec
+			<< ", \"speedup\": " << r.Speedup << ", \"efficiency\": " << r.Efficiency << ", \"queue_full\": " << r.Waited
+			<< ", \"worker_charts\": { \"min\": " << r.MinJobs << ", \"max\": " << r.MaxJobs << " } }"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+
+	std::cout << "pool: results written to " << out << ".csv and " << out << ".json" << std::endl;
+	return true;
+}
+
+int PoolBench(int argc, char** argv) {
+	const unsigned int QUEUE_PER_WORKER = 4;   // queued charts per worker before Submit() waits
+
+	unsigned int charts = argc > 0 ? (unsigned int)atof(argv[0]) : 1000;
+	unsigned int maxWorkers = argc > 1 ? (unsigned int)atoi(argv[1]) : std::thread::hardware_concurrency();
+	int size = argc > 2 ? atoi(argv[2]) : 256;
+	std::string out = argc > 3 ? argv[3] : "pool_results";
+	if (charts == 0 || maxWorkers == 0 || size < 16) {
+		std::cout << "pool: needs at least one chart, one worker and 16x16 pixels" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::string dir = out + "_images";
+	std::filesystem::create_directories(dir);
+	if (!InitBenchPlatform())
+		return EXIT_FAILURE;
+
+	std::vector<unsigned int> workerCounts;
+	for (unsigned int workers = 1; workers < maxWorkers; workers *= 2)
+		workerCounts.push_back(workers);
+	workerCounts.push_back(maxWorkers);
+
+	std::cout << "pool: " << charts << " charts of " << size << "x" << size << " to " << dir << "/, up to " << maxWorkers
+		<< " workers (" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+
+	bool consistent = true;
+	double baseMs = 0.0;
+	uint64_t baseChecksum = 0;
+	std::vector<PoolResult> results;
+	for (unsigned int workers : workerCounts) {
+		RenderPool* pool = new RenderPool(workers, workers * QUEUE_PER_WORKER, size, size);
+		if (!pool->IsValid()) {
+			std::cout << "pool: cannot create " << workers << " render contexts" << std::endl;
+			delete pool;
+			glfwTerminate();
+			return EXIT_FAILURE;
+		}
+
+		/* this thread is the producer; the queue holds it back once the workers fall behind */
+		BenchTimer timer;
+		for (unsigned int i = 0; i < charts; i++)
+			pool->Submit(makeChart(i, dir));
+		pool->Finish();
+		double ms = timer.ElapsedMs();
+
+		uint64_t checksum = 0, failed = 0, minJobs = charts, maxJobs = 0;
+		for (unsigned int w = 0; w < pool->Workers(); w++) {
+			const RenderPool::WorkerStats& stats = pool->Stats(w);
+			checksum += stats.Checksum;
+			failed += stats.Failed;
+			minJobs = std::min(minJobs, stats.Jobs);
+			maxJobs = std::max(maxJobs, stats.Jobs);
+		}
+		pool->Report();
+
+		if (workers == 1) {
+			baseMs = ms;
+			baseChecksum = checksum;
+		}
+		else if (checksum != baseChecksum) {
+			std::cout << "pool: " << workers << " workers drew different images than one worker" << std::endl;
+			consistent = false;
+		}
+		if (failed)
+			consistent = false;
+
+		PoolResult r = { workers, ms, charts * 1000.0 / ms, baseMs / ms, baseMs / ms / workers, pool->Waited(), minJobs, maxJobs };
+		std::cout << "  x" << r.Workers << ": " << r.Ms << " ms, " << r.ChartsPerSec << " charts/s, speedup " << r.Speedup
+			<< ", efficiency " << r.Efficiency << std::endl;
+		results.push_back(r);
+		delete pool;
+	}
+	glfwTerminate();
+
+	if (!writeResults(out, results, charts, size))
+		return EXIT_FAILURE;
+	return consistent ? EXIT_SUCCESS : EXIT_FAILURE;
+}
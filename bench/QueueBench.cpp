@@ -0,0 +1,159 @@
+/*
+ * Cross-thread submission through the render command queue.  For each policy
+ * (drop, spin, block), `producers` threads submit `commands` commands between
+ * them, while this thread plays the GL thread: it drains the queue, then sleeps
+ * for drainUs as if it were drawing a frame.  Reported per policy:
+ *   throughput         commands drained per second
+ *   enqueue latency    time a Submit() call took, in ns; includes any waiting for room.
+ *                      Recorded in ns, the histogram clamps it at MAX_VALUE ns, ~0.134 s
+ *   queue latency      time from Submit() to the drain that took the command, in us
+ * Each producer numbers its commands, and the drain checks that they arrive in
+ * order and that nothing is lost except what the drop policy dropped.  Results
+ * go to <out>.csv and <out>.json.
+ */
+#include "Bench.h"
+#include "RenderCommands.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct QueueResult
+{
+	QueueFullPolicy Policy;
+	unsigned long long Drained;
+	unsigned long long Dropped;
+	unsigned long long Waited;
+	double Seconds;
+	LatencyHistogram Enqueue;   // ns, not us
+	LatencyHistogram Queue;     // us
+	bool InOrder;
+};
+
+static void produce(RenderCommandQueue* queue, unsigned int producer, unsigned long long commands,
+	LatencyHistogram* enqueue, std::atomic<unsigned int>* done) {
+	typedef std::chrono::steady_clock Clock;
+	RenderCommand command = {};
+	command.Type = RenderCommand::SET_ENABLED;
+	command.Entity = producer;
+	for (unsigned long long i = 0; i < commands; i++) {
+		command.Positions[0] = (float)i;   // the sequence number; exact up to 2^24
+		Clock::time_point start = Clock::now();
+		queue->Submit(command);
+		enqueue->Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+	}
+	done->fetch_add(1, std::memory_order_release);
+}
+
+static QueueResult runPolicy(QueueFullPolicy policy, unsigned int producers, unsigned long long commands, int drainUs) {
+	QueueResult result = {};
+	result.Policy = policy;
+	result.InOrder = true;
+	std::unique_ptr<RenderCommandQueue> queue(new RenderCommandQueue(policy));
+	std::vector<LatencyHistogram> enqueue(producers);
+	std::vector<float> next(producers, 0.0f);
+	std::atomic<unsigned int> done(0);
+
+	BenchTimer timer;
+	std::vector<std::thread> threads;
+	for (unsigned int p = 0; p < producers; p++)
+		threads.emplace_back(produce, queue.get(), p, commands / producers, &enqueue[p], &done);
+
+	for (;;) {
+		/* read before draining, so a queue found empty after the last producer finished is really empty */
+		bool finished = done.load(std::memory_order_acquire) == producers;
+		result.Drained += queue->Drain([&](const RenderCommand& command) {
+			if (command.Positions[0] < next[command.Entity])
+				result.InOrder = false;
+			next[command.Entity] = command.Positions[0] + 1.0f;
+		});
+		if (finished && queue->Size() == 0)
+			break;
+		if (drainUs > 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(drainUs));
+	}
+	result.Seconds = timer.ElapsedMs() / 1000.0;
+	for (std::thread& thread : threads)
+		thread.join();
+
+	result.Dropped = queue->Dropped();
+	result.Waited = queue->Waited();
+	result.Queue = queue->QueueLatency();
+	for (const LatencyHistogram& histogram : enqueue)
+		result.Enqueue.Merge(histogram);
+	return result;
+}
+
+static bool writeResults(const std::string& out, const std::vector<QueueResult>& results, unsigned int producers,
+	unsigned long long commands, int drainUs) {
+	std::ofstream csv(out + ".csv");
+	std::ofstream json(out + ".json");
+	if (!csv || !json) {
+		std::cout << "queue: cannot write " << out << ".csv/.json" << std::endl;
+		return false;
+	}
+
+	csv << "policy,producers,commands,drained,dropped,waited,seconds,commands_per_sec,"
+		"enqueue_p50_ns,enqueue_p99_ns,enqueue_max_ns,queue_p50_us,queue_p99_us,queue_max_us\n";
+	json << "{\n  \"producers\": " << producers << ",\n  \"commands\": " << commands << ",\n  \"drain_us\": " << drainUs
+		<< ",\n  \"capacity\": " << RenderCommandQueue::CAPACITY << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const QueueResult& r = results[i];
+		const char* policy = RenderCommandQueue::PolicyName(r.Policy);
+		csv << policy << ',' << producers << ',' << commands << ',' << r.Drained << ',' << r.Dropped << ',' << r.Waited << ','
+			<< r.Seconds << ',' << r.Drained / r.Seconds << ',' << r.Enqueue.Percentile(50) << ',' << r.Enqueue.Percentile(99)
+			<< ',' << r.Enqueue.Max() << ',' << r.Queue.Percentile(50) << ',' << r.Queue.Percentile(99) << ',' << r.Queue.Max() << '\n';
+		json << "    { \"policy\": \"" << policy << "\", \"drained\": " << r.Drained << ", \"dropped\": " << r.Dropped
+			<< ", \"waited\": " << r.Waited << ", \"seconds\": " << r.Seconds << ", \"commands_per_sec\": " << r.Drained / r.Seconds
+			<< ", \"enqueue_ns\": { \"p50\": " << r.Enqueue.Percentile(50) << ", \"p99\": " << r.Enqueue.Percentile(99)
+			<< ", \"max\": " << r.Enqueue.Max() << " }, \"queue_us\": { \"p50\": " << r.Queue.Percentile(50)
+			<< ", \"p99\": " << r.Queue.Percentile(99) << ", \"max\": " << r.Queue.Max() << " } }"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+
+	std::cout << "queue: results written to " << out << ".csv and " << out << ".json" << std::endl;
+	return true;
+}
+
+int QueueBench(int argc, char** argv) {
+	unsigned int producers = argc > 0 ? (unsigned int)atoi(argv[0]) : 4;
+	unsigned long long commands = argc > 1 ? (unsigned long long)atof(argv[1]) : 1000000ull;
+	int drainUs = argc > 2 ? atoi(argv[2]) : 1000;
+	std::string out = argc > 3 ? argv[3] : "queue_results";
+	if (producers == 0 || commands < producers || commands / producers > (1ull << 24) || drainUs < 0) {
+		std::cout << "queue: needs at least one producer, one command each and at most 2^24 per producer" << std::endl;
+		return EXIT_FAILURE;
+	}
+	commands -= commands % producers;
+
+	std::cout << "queue: " << producers << " producers, " << commands << " commands, drain every " << drainUs
+		<< " us, capacity " << RenderCommandQueue::CAPACITY << std::endl;
+
+	bool valid = true;
+	std::vector<QueueResult> results;
+	const QueueFullPolicy policies[] = { QueueFullPolicy::Drop, QueueFullPolicy::Spin, QueueFullPolicy::Block };
+	for (QueueFullPolicy policy : policies) {
+		QueueResult r = runPolicy(policy, producers, commands, drainUs);
+		std::cout << "  " << RenderCommandQueue::PolicyName(policy) << ": " << r.Drained / r.Seconds << " commands/s, "
+			<< r.Dropped << " dropped, " << r.Waited << " waited, enqueue p50 " << r.Enqueue.Percentile(50) << " ns p99 "
+			<< r.Enqueue.Percentile(99) << " ns, in queue p50 " << r.Queue.Percentile(50) << " us p99 "
+			<< r.Queue.Percentile(99) << " us" << std::endl;
+
+		if (!r.InOrder || r.Drained + r.Dropped != commands || (policy != QueueFullPolicy::Drop && r.Dropped)) {
+			std::cout << "queue: " << RenderCommandQueue::PolicyName(policy) << " lost or reordered commands" << std::endl;
+			valid = false;
+		}
+		results.push_back(r);
+	}
+
+	if (!writeResults(out, results, producers, commands, drainUs))
+		return EXIT_FAILURE;
+	return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,290 @@
+/*
+ * Scaling of every draw path with scene size.  Seeded synthetic scenes from 10^3
+ * primitives up to a limit (10^7 by default) go through Points, Lines (strip),
+ * Triangle, an indexed mesh in a single glDrawElements, and an instanced draw,
+ * into an offscreen framebuffer.  Results are written to <out>.csv and
+ * <out>.json; `compare` checks a CSV against a stored baseline.  With --perf
+ * the submit loop also runs under hardware counters (Linux perf_event_open).
+ */
+#include "Bench.h"
+#include "PerfCounters.h"
+#include "SceneGenerator.h"
+#include "FrameBuffer.h"
+#include "IndexBuffer.h"
+#include "JobSystem.h"
+#include "Lines.h"
+#include "ParameterBuffer.h"
+#include "Points.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShaderLibrary.h"
+#include "Triangle.h"
+#include "VertexBuffer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class DrawPath
+{
+	Points,      // Points::Draw
+	LineStrip,   // Lines::Draw with GL_LINE_STRIP
+	Triangles,   // Triangle::Draw over a triangle soup
+	IndexedMesh, // shared vertices, one glDrawElements over the whole index buffer
+	Instanced    // one triangle, one instance per primitive
+};
+
+struct PathInfo
+{
+	const char* Name;
+	DrawPath Path;
+	GeneratedScene (*Generate)(unsigned long long count, uint64_t seed, JobSystem* jobs);
+};
+
+static const PathInfo paths[] =
+{
+	{ "points",              DrawPath::Points,      SceneGenerator::Points },
+	{ "line_strip",          DrawPath::LineStrip,   SceneGenerator::LineStrip },
+	{ "triangles",           DrawPath::Triangles,   SceneGenerator::TriangleSoup },
+	{ "triangles_indexed",   DrawPath::IndexedMesh, SceneGenerator::TriangleMesh },
+	{ "triangles_instanced", DrawPath::Instanced,   SceneGenerator::TriangleInstances },
+};
+
+struct SceneResult
+{
+	const char* Path;
+	unsigned long long Primitives;
+	int Frames;
+	double UploadMs;   // creating and filling the buffers, finished on the GPU
+	double CpuMs;      // submitting one frame
+	double FrameMs;    // one frame including GPU completion
+	double PrimitivesPerSec;
+	double Counters[PerfCounters::COUNTER_COUNT];  // per frame, user space of this thread only
+};
+
+static SceneResult runScene(const PathInfo& path, const GeneratedScene& scene, int frames, Shader& basic, Shader& instanced, PerfCounters* counters) {
+	SceneResult result = { path.Name, scene.Primitives, frames, 0.0, 0.0, 0.0, 0.0, {} };
+	unsigned int instances = (unsigned int)(scene.InstanceOffsets.size() / 2);
+
+	BenchTimer timer;
+	std::unique_ptr<VertexBuffer> offsets;
+	if (instances) {
+		offsets = std::make_unique<VertexBuffer>(scene.InstanceOffsets.data(), (int)scene.InstanceOffsets.size());
+		GlCall(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0));
+		GlCall(glVertexAttribDivisor(1, 1));
+		GlCall(glEnableVertexAttribArray(1));
+	}
+	/* created last, so it stays bound to GL_ARRAY_BUFFER for the draw wrappers' attribute pointers */
+	VertexBuffer vertices(scene.Vertices.data(), (int)scene.Vertices.size());
+	IndexBuffer indices(scene.Indices.data(), (unsigned int)scene.Indices.size());
+	GlCall(glFinish());
+	result.UploadMs = timer.ElapsedMs();
+
+	if (path.Path == DrawPath::Instanced)
+		instanced.Bind();
+	else
+		basic.Bind();
+
+	Points points(vertices, indices);
+	Lines lines(vertices, indices, GL_LINE_STRIP);
+	Triangle triangles(vertices, indices);
+	auto draw = [&]() {
+		switch (path.Path) {
+			case DrawPath::Points:
+				points.Draw(0);
+				break;
+			case DrawPath::LineStrip:
+				lines.Draw(0);
+				break;
+			case DrawPath::Triangles:
+				triangles.Draw(0);
+				break;
+			case DrawPath::IndexedMesh:
+				GlCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0));
+				GlCall(glDrawElements(GL_TRIANGLES, indices.GetCount(), GL_UNSIGNED_INT, nullptr));
+				CountDraw(indices.GetCount());
+				break;
+			case DrawPath::Instanced:
+				GlCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0));
+				GlCall(glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr, instances, 0));
+				CountDraw(3ull * instances);
+				break;
+		}
+	};
+
+	/* the first draw pays for validation and residency; keep it out of the numbers */
+	draw();
+	GlCall(glFinish());
+
+	double submitMs = 0.0;
+	if (counters)
+		counters->Reset();
+	timer.Reset();
+	for (int i = 0; i < frames; i++) {
+		GlCall(glClear(GL_COLOR_BUFFER_BIT));
+		BenchTimer submit;
+		if (counters)
+			counters->Start();
+		draw();
+		if (counters)
+			counters->Stop();
+		submitMs += submit.ElapsedMs();
+	}
+	GlCall(glFinish());
+	double totalMs = timer.ElapsedMs();
+
+	if (instances) {
+		GlCall(glDisableVertexAttribArray(1));
+		GlCall(glVertexAttribDivisor(1, 0));
+	}
+
+	result.CpuMs = submitMs / frames;
+	result.FrameMs = totalMs / frames;
+	result.PrimitivesPerSec = scene.Primitives * frames / (totalMs / 1000.0);
+	if (counters)
+		for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+			result.Counters[i] = (double)counters->Total((PerfCounters::Counter)i) / frames;
+	return result;
+}
+
+/* counter columns per frame and per primitive; a counter the CPU does not offer stays empty */
+static void writeCounters(std::ostream& csv, std::ostream& json, const SceneResult& r, const PerfCounters& counters) {
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++) {
+		PerfCounters::Counter counter = (PerfCounters::Counter)i;
+		const char* name = PerfCounters::Name(counter);
+		csv << ',';
+		if (counters.Has(counter)) {
+			csv << r.Counters[i] << ',' << r.Counters[i] / r.Primitives;
+			json << ", \"" << name << "_per_frame\": " << r.Counters[i]
+				<< ", \"" << name << "_per_primitive\": " << r.Counters[i] / r.Primitives;
+		}
+		else
+			csv << ',';
+	}
+	csv << ',';
+	double cycles = r.Counters[PerfCounters::CYCLES];
+	if (counters.Has(PerfCounters::CYCLES) && counters.Has(PerfCounters::INSTRUCTIONS) && cycles > 0.0) {
+		csv << r.Counters[PerfCounters::INSTRUCTIONS] / cycles;
+		json << ", \"ipc\": " << r.Counters[PerfCounters::INSTRUCTIONS] / cycles;
+	}
+}
+
+static bool writeResults(const std::string& out, const std::vector<SceneResult>& results, uint64_t seed, const PerfCounters* counters) {
+	std::ofstream csv(out + ".csv");
+	std::ofstream json(out + ".json");
+	if (!csv || !json) {
+		std::cout << "scene: cannot write " << out << ".csv/.json" << std::endl;
+		return false;
+	}
+
+	csv << "path,primitives,frames,upload_ms,cpu_ms,frame_ms,primitives_per_sec";
+	if (counters) {
+		for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++) {
+			const char* name = PerfCounters::Name((PerfCounters::Counter)i);
+			csv << ',' << name << "_per_frame," << name << "_per_primitive";
+		}
+		csv << ",ipc";
+	}
+	csv << '\n';
+	json << "{\n  \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n  \"seed\": " << seed << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const SceneResult& r = results[i];
+		csv << r.Path << ',' << r.Primitives << ',' << r.Frames << ',' << r.UploadMs << ',' << r.CpuMs << ','
+			<< r.FrameMs << ',' << r.PrimitivesPerSec;
+		json << "    { \"path\": \"" << r.Path << "\", \"primitives\": " << r.Primitives << ", \"frames\": " << r.Frames
+			<< ", \"upload_ms\": " << r.UploadMs << ", \"cpu_ms\": " << r.CpuMs << ", \"frame_ms\": " << r.FrameMs
+			<< ", \"primitives_per_sec\": " << r.PrimitivesPerSec;
+		if (counters)
+			writeCounters(csv, json, r, *counters);
+		csv << '\n';
+		json << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+
+	std::cout << "scene: results written to " << out << ".csv and " << out << ".json" << std::endl;
+	return true;
+}
+
+int SceneBench(int argc, char** argv) {
+	/* --perf may appear anywhere; the rest are positional */
+	std::vector<const char*> args;
+	bool perf = false;
+	for (int i = 0; i < argc; i++) {
+		if (std::string(argv[i]) == "--perf")
+			perf = true;
+		else
+			args.push_back(argv[i]);
+	}
+	unsigned long long maxPrimitives = args.size() > 0 ? (unsigned long long)atof(args[0]) : 10000000ull;
+	int frames = args.size() > 1 ? atoi(args[1]) : 10;
+	uint64_t seed = args.size() > 2 ? strtoull(args[2], nullptr, 10) : 1;
+	std::string out = args.size() > 3 ? args[3] : "scene_results";
+	if (maxPrimitives < 1000 || frames <= 0) {
+		std::cout << "scene: needs at least 1000 primitives and one frame" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	/* without permission the bench still runs, just without the counter columns */
+	PerfCounters counters;
+	PerfCounters* active = perf && counters.Open() ? &counters : nullptr;
+
+	GLFWwindow* window = CreateBenchContext();
+	if (!window)
+		return EXIT_FAILURE;
+
+	int status = EXIT_FAILURE;
+	{
+		JobSystem jobs;  // scenes are generated on every core
+		ShaderLibrary shaders;
+		/* the instanced path is Basic built with INSTANCED, which adds the per-instance offset */
+		const ShaderDefines INSTANCED = { { "INSTANCED", "1" } };
+		shaders.Add("Basic", "res/shaders/Basic.shader");
+		shaders.Request("Basic", INSTANCED);
+		shaders.Build();
+		Shader* basic = shaders.Get("Basic");
+		Shader* instanced = shaders.Get("Basic", INSTANCED);
+
+		FrameBuffer target(640, 480);
+		if (basic && instanced && target.IsComplete()) {
+			target.Bind();
+
+			unsigned int vao;
+			GlCall(glGenVertexArrays(1, &vao));
+			GlCall(glBindVertexArray(vao));
+			GlCall(glEnableVertexAttribArray(0));
+
+			ParameterBuffer params(1);
+			ViewParams view = {};
+			view.ViewProjection[0] = view.ViewProjection[5] = view.ViewProjection[10] = view.ViewProjection[15] = 1.0f;
+			params.SetView(view);
+			params.SetObject(0, { { 1.0f, 1.0f, 1.0f, 1.0f } });
+			params.Flush();
+			params.Bind();
+
+			std::vector<SceneResult> results;
+			for (unsigned long long count = 1000; count <= maxPrimitives; count *= 10) {
+				for (const PathInfo& path : paths) {
+					GeneratedScene scene = path.Generate(count, seed, &jobs);
+					SceneResult r = runScene(path, scene, frames, *basic, *instanced, active);
+					std::cout << "  " << r.Path << " x" << r.Primitives << ": upload " << r.UploadMs << " ms, cpu "
+						<< r.CpuMs << " ms, frame " << r.FrameMs << " ms, " << r.PrimitivesPerSec << " primitives/s";
+					if (active && active->Has(PerfCounters::CYCLES) && active->Has(PerfCounters::INSTRUCTIONS))
+						std::cout << ", " << r.Counters[PerfCounters::CYCLES] / r.Primitives << " cycles and "
+							<< r.Counters[PerfCounters::INSTRUCTIONS] / r.Primitives << " instructions/primitive";
+					std::cout << std::endl;
+					results.push_back(r);
+				}
+			}
+
+			GlCall(glDeleteVertexArrays(1, &vao));
+			target.Unbind();
+			status = writeResults(out, results, seed, active) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	DestroyBenchContext(window);
+	return status;
+}
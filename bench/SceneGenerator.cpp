@@ -0,0 +1,184 @@
+#include "SceneGenerator.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* calls f(begin, end) over the chunks of count items, on the jobs when there are any */
+template<typename F>
+static void forChunks(JobSystem* jobs, unsigned long long count, unsigned long long chunkSize, const F& f)
+{
+	unsigned int chunks = (unsigned int)((count + chunkSize - 1) / chunkSize);
+	if (jobs)
+		jobs->ParallelFor(chunks, 1, f);
+	else
+		f(0u, chunks);
+}
+
+static void identityIndices(GeneratedScene& scene, JobSystem* jobs)
+{
+	size_t vertices = scene.Vertices.size() / scene.Components;
+	scene.Indices.resize(vertices);
+	unsigned int* indices = scene.Indices.data();
+	forChunks(jobs, vertices, SceneGenerator::CHUNK, [=](unsigned int begin, unsigned int end) {
+		for (size_t i = begin * SceneGenerator::CHUNK; i < end * SceneGenerator::CHUNK && i < vertices; i++)
+			indices[i] = (unsigned int)i;
+	});
+}
+
+/* edge length that keeps count primitives from covering the screen many times over */
+static float primitiveSize(unsigned long long count)
+{
+	return 4.0f / std::sqrt((float)count);
+}
+
+namespace SceneGenerator {
+
+	GeneratedScene Points(unsigned long long count, uint64_t seed, JobSystem* jobs)
+	{
+		GeneratedScene scene;
+		scene.Components = 2;
+		scene.Primitives = count;
+		scene.Vertices.resize(count * 2);
+
+		float* vertices = scene.Vertices.data();
+		forChunks(jobs, count, CHUNK, [=](unsigned int begin, unsigned int end) {
+			for (unsigned long long chunk = begin; chunk < end; chunk++)
+			{
+				SceneRandom random = SceneRandom::ForChunk(seed, chunk);
+				unsigned long long last = std::min(count, (chunk + 1) * CHUNK);
+				for (unsigned long long i = chunk * CHUNK * 2; i < last * 2; i++)
+					vertices[i] = random.Range(-1.0f, 1.0f);
+			}
+		});
+		identityIndices(scene, jobs);
+		return scene;
+	}
+
+	GeneratedScene LineStrip(unsigned long long count, uint64_t seed, JobSystem* jobs)
+	{
+		SceneRandom random(seed);
+		GeneratedScene scene;
+		scene.Components = 2;
+		scene.Primitives = count;
+		scene.Vertices.resize((count + 1) * 2);
+
+		float step = primitiveSize(count);
+		float x = 0.0f, y = 0.0f;
+		for (unsigned long long i = 0; i <= count; i++)
+		{
+			scene.Vertices[i * 2] = x;
+			scene.Vertices[i * 2 + 1] = y;
+			x = std::fmax(-1.0f, std::fmin(1.0f, x + random.Range(-step, step)));
+			y = std::fmax(-1.0f, std::fmin(1.0f, y + random.Range(-step, step)));
+		}
+		identityIndices(scene, jobs);
+		return scene;
+	}
+
+	GeneratedScene TriangleSoup(unsigned long long count, uint64_t seed, JobSystem* jobs)
+	{
+		GeneratedScene scene;
+		scene.Components = 3;
+		scene.Primitives = count;
+		scene.Vertices.resize(count * 9);
+
+		float size = primitiveSize(count);
+		float* vertices = scene.Vertices.data();
+		forChunks(jobs, count, CHUNK, [=](unsigned int begin, unsigned int end) {
+			for (unsigned long long chunk = begin; chunk < end; chunk++)
+			{
+				SceneRandom random = SceneRandom::ForChunk(seed, chunk);
+				unsigned long long last = std::min(count, (chunk + 1) * CHUNK);
+				float* v = vertices + chunk * CHUNK * 9;
+				for (unsigned long long i = chunk * CHUNK; i < last; i++, v += 9)
+				{
+					float x = random.Range(-1.0f, 1.0f);
+					float y = random.Range(-1.0f, 1.0f);
+					v[0] = x;                                    v[1] = y;                                    v[2] = 0.0f;
+					v[3] = x + random.Range(0.2f, 1.0f) * size;  v[4] = y;                                    v[5] = 0.0f;
+					v[6] = x;                                    v[7] = y + random.Range(0.2f, 1.0f) * size;  v[8] = 0.0f;
+				}
+			}
+		});
+		identityIndices(scene, jobs);
+		return scene;
+	}
+
+	GeneratedScene TriangleMesh(unsigned long long count, uint64_t seed, JobSystem* jobs)
+	{
+		GeneratedScene scene;
+		scene.Components = 3;
+		scene.Primitives = count;
+
+		unsigned long long cells = (count + 1) / 2;
+		unsigned long long columns = (unsigned long long)std::ceil(std::sqrt((double)cells));
+		unsigned long long rows = (cells + columns - 1) / columns;
+
+		float cellWidth = 2.0f / columns, cellHeight = 2.0f / rows;
+		scene.Vertices.resize((columns + 1) * (rows + 1) * 3);
+		float* vertices = scene.Vertices.data();
+		forChunks(jobs, rows + 1, 1, [=](unsigned int begin, unsigned int end) {
+			for (unsigned long long r = begin; r < end; r++)
+			{
+				SceneRandom random = SceneRandom::ForChunk(seed, r);
+				float* v = vertices + r * (columns + 1) * 3;
+				for (unsigned long long c = 0; c <= columns; c++, v += 3)
+				{
+					/* interior vertices move by up to a quarter cell, so no triangle flips */
+					bool interior = r > 0 && r < rows && c > 0 && c < columns;
+					float jitterX = interior ? random.Range(-0.25f, 0.25f) * cellWidth : 0.0f;
+					float jitterY = interior ? random.Range(-0.25f, 0.25f) * cellHeight : 0.0f;
+					v[0] = -1.0f + c * cellWidth + jitterX;
+					v[1] = -1.0f + r * cellHeight + jitterY;
+					v[2] = 0.0f;
+				}
+			}
+		});
+
+		scene.Indices.resize(count * 3);
+		unsigned int* indices = scene.Indices.data();
+		forChunks(jobs, count, CHUNK, [=](unsigned int begin, unsigned int end) {
+			for (unsigned long long i = begin * CHUNK; i < end * CHUNK && i < count; i++)
+			{
+				unsigned long long cell = i / 2;
+				unsigned int corner = (unsigned int)((cell / columns) * (columns + 1) + cell % columns);
+				unsigned int above = corner + (unsigned int)(columns + 1);
+				unsigned int* triangle = indices + i * 3;
+				if (i % 2 == 0)
+				{
+					triangle[0] = corner;      triangle[1] = corner + 1;  triangle[2] = above;
+				}
+				else
+				{
+					triangle[0] = corner + 1;  triangle[1] = above + 1;   triangle[2] = above;
+				}
+			}
+		});
+		return scene;
+	}
+
+	GeneratedScene TriangleInstances(unsigned long long count, uint64_t seed, JobSystem* jobs)
+	{
+		GeneratedScene scene;
+		scene.Components = 3;
+		scene.Primitives = count;
+
+		float size = primitiveSize(count);
+		scene.Vertices = { 0.0f, 0.0f, 0.0f, size, 0.0f, 0.0f, 0.0f, size, 0.0f };
+		scene.Indices = { 0, 1, 2 };
+		scene.InstanceOffsets.resize(count * 2);
+		float* offsets = scene.InstanceOffsets.data();
+		forChunks(jobs, count, CHUNK, [=](unsigned int begin, unsigned int end) {
+			for (unsigned long long chunk = begin; chunk < end; chunk++)
+			{
+				SceneRandom random = SceneRandom::ForChunk(seed, chunk);
+				unsigned long long last = std::min(count, (chunk + 1) * CHUNK);
+				for (unsigned long long i = chunk * CHUNK * 2; i < last * 2; i++)
+					offsets[i] = random.Range(-1.0f, 1.0f);
+			}
+		});
+		return scene;
+	}
+
+}
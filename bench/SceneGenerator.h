@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+/*
+ * Synthetic scenes for the scaling benchmarks.  Generation is seeded and uses
+ * its own generator instead of <random> distributions, whose output differs
+ * between standard libraries, so a seed describes the same scene everywhere.
+ * Positions lie in normalized device coordinates.
+ *
+ * With a JobSystem the scenes are generated in parallel.  Every chunk of
+ * CHUNK primitives draws from its own random stream, so the result does not
+ * depend on the number of workers.
+ */
+struct GeneratedScene
+{
+	std::vector<float> Vertices;
+	std::vector<unsigned int> Indices;
+	std::vector<float> InstanceOffsets;  // x, y per instance; empty unless instanced
+	unsigned int Components;             // floats per vertex
+	unsigned long long Primitives;
+};
+
+/* splitmix64 */
+class SceneRandom
+{
+private:
+	uint64_t m_State;
+public:
+	SceneRandom(uint64_t seed) : m_State(seed) {}
+	/* an independent stream for one chunk of a scene */
+	static SceneRandom ForChunk(uint64_t seed, uint64_t chunk)
+	{
+		return SceneRandom(SceneRandom(seed ^ (chunk * 0xD1B54A32D192ED03ull)).Next());
+	}
+
+	uint64_t Next()
+	{
+		uint64_t z = (m_State += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+	/* uniform in [lo, hi) with 24 bits of precision */
+	float Range(float lo, float hi)
+	{
+		return lo + (float)(Next() >> 40) * (1.0f / 16777216.0f) * (hi - lo);
+	}
+};
+
+namespace SceneGenerator {
+
+	const unsigned long long CHUNK = 65536;   // primitives per random stream and per job
+
+	/* count points, one vertex each */
+	GeneratedScene Points(unsigned long long count, uint64_t seed, JobSystem* jobs = nullptr);
+	/* a random walk of count segments, drawn as one GL_LINE_STRIP; a walk is sequential, so jobs only fill the indices */
+	GeneratedScene LineStrip(unsigned long long count, uint64_t seed, JobSystem* jobs = nullptr);
+	/* count independent small triangles, three vertices each, the layout Triangle::Draw expects */
+	GeneratedScene TriangleSoup(unsigned long long count, uint64_t seed, JobSystem* jobs = nullptr);
+	/* a jittered grid mesh of count triangles sharing vertices through the index buffer; a stream per row */
+	GeneratedScene TriangleMesh(unsigned long long count, uint64_t seed, JobSystem* jobs = nullptr);
+	/* one small triangle drawn count times with a per-instance offset */
+	GeneratedScene TriangleInstances(unsigned long long count, uint64_t seed, JobSystem* jobs = nullptr);
+
+}
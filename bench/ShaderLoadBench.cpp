@@ -0,0 +1,115 @@
+/*
+ * Startup cost of loading a large shader library from disk: splitting the
+ * #shader stages and resolving #includes, before anything reaches the driver.
+ * Compares the memory-mapped Shader::ParseShader() against the previous
+ * ifstream/getline/stringstream reader.
+ */
+#include "Bench.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const int ITERATIONS = 5;
+
+static void writeShaderFiles(const std::string& dir, int count) {
+	std::filesystem::create_directories(dir);
+
+	std::ofstream common(dir + "/Common.glsl");
+	for (int i = 0; i < 40; i++)
+		common << "vec4 palette" << i << "(float t) { return vec4(t, 1.0 - t, " << i << ".0 / 40.0, 1.0); }\n";
+
+	for (int f = 0; f < count; f++) {
+		std::ofstream file(dir + "/Shader" + std::to_string(f) + ".shader");
+		file << "#shader vertex\n#version 460 core\n\nlayout(location = 0) in vec4 position;\n";
+		for (int i = 0; i < 60; i++)
+			file << "uniform vec4 u_Offset" << i << ";  // per-variant transform parameter\n";
+		file << "\nvoid main()\n{\n     gl_Position = position + u_Offset" << f % 60 << ";\n};\n\n";
+		file << "#shader fragment\n#version 460 core\n#include \"Common.glsl\"\n\n";
+		file << "layout(location = 0) out vec4 color;\n\nuniform vec4 u_Color;\n";
+		for (int i = 0; i < 60; i++)
+			file << "uniform float u_Weight" << i << ";  // per-variant blend weight\n";
+		file << "\nvoid main()\n{\n    color = u_Color * palette" << f % 40 << "(u_Weight0);\n};\n";
+	}
+}
+
+/* the reader Shader::ParseShader() used before it mapped files, minus the console dump, kept as the baseline */
+static size_t parseWithStreams(const std::string& filepath, const std::string& dir) {
+	std::ifstream stream(filepath);
+	std::string line;
+	std::stringstream ss[2];
+	int type = -1;
+	while (getline(stream, line)) {
+		if (line.find("#shader") != std::string::npos) {
+			type = line.find("vertex") != std::string::npos ? 0 : 1;
+		}
+		else if (type >= 0 && line.find("#include") == 0) {
+			std::ifstream include(dir + "/" + line.substr(10, line.size() - 11));
+			ss[type] << include.rdbuf() << '\n';
+		}
+		else if (type >= 0) {
+			ss[type] << line << '\n';
+		}
+	}
+	std::string vertex = ss[0].str();
+	std::string fragment = ss[1].str();
+	return vertex.size() + fragment.size();
+}
+
+static size_t parseMapped(const std::string& filepath) {
+	ShaderProgramSource source = Shader::ParseShader(filepath);
+	size_t bytes = 0;
+	for (std::string_view piece : source.VertexSource)
+		bytes += piece.size();
+	for (std::string_view piece : source.FragmentSource)
+		bytes += piece.size();
+	return bytes;
+}
+
+static void report(const char* name, const std::vector<double>& timesMs, size_t files, size_t bytes) {
+	double best = *std::min_element(timesMs.begin(), timesMs.end());
+	std::cout << name << ": best " << best << " ms, "
+		<< best * 1000.0 / files << " us/file, "
+		<< bytes / (best / 1000.0) / (1024.0 * 1024.0) << " MB/s" << std::endl;
+}
+
+int ShaderLoadBench(int argc, char** argv) {
+	int count = argc > 0 ? atoi(argv[0]) : 300;
+	std::string dir = argc > 1 ? argv[1] : "bench_shaders";
+	if (count <= 0) {
+		std::cout << "shaderload: file count must be positive" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	writeShaderFiles(dir, count);
+	std::vector<std::string> paths;
+	for (int f = 0; f < count; f++)
+		paths.push_back(dir + "/Shader" + std::to_string(f) + ".shader");
+
+	std::vector<double> streamTimes, mappedTimes;
+	size_t streamBytes = 0, mappedBytes = 0;
+	for (int i = 0; i < ITERATIONS; i++) {
+		BenchTimer timer;
+		streamBytes = 0;
+		for (const std::string& path : paths)
+			streamBytes += parseWithStreams(path, dir);
+		streamTimes.push_back(timer.ElapsedMs());
+
+		timer.Reset();
+		mappedBytes = 0;
+		for (const std::string& path : paths)
+			mappedBytes += parseMapped(path);
+		mappedTimes.push_back(timer.ElapsedMs());
+	}
+
+	std::cout << "shaderload: " << count << " files, " << ITERATIONS << " iterations (warm file cache)" << std::endl;
+	report("  ifstream+getline", streamTimes, paths.size(), streamBytes);
+	report("  mapped+views    ", mappedTimes, paths.size(), mappedBytes);
+	return EXIT_SUCCESS;
+}
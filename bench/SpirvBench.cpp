@@ -0,0 +1,89 @@
+/*
+ * Startup cost of building programs from GLSL text against building them from
+ * precompiled SPIR-V.  Each run makes `programs` copies of Basic in a fresh
+ * ShaderLibrary, every other one specialized for round points through the
+ * fragment module's constant_id 0; the vertex module gets no constants.
+ *
+ * The modules are not in the repository; compile res/shaders/spirv/Basic.vert
+ * and Basic.frag with glslangValidator -G first.  Mesa caches compiled shaders
+ * on disk, so run with MESA_SHADER_CACHE_DISABLE=true to time the front end.
+ */
+#include "Bench.h"
+#include "Renderer.h"
+#include "ShaderLibrary.h"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const int ITERATIONS = 3;
+
+/* ms to build every program, or a negative value if one of them failed */
+static double buildPrograms(int programs, bool spirv, const std::string& dir) {
+	BenchTimer timer;
+	ShaderLibrary shaders;
+	for (int i = 0; i < programs; i++) {
+		std::string name = "Basic" + std::to_string(i);
+		if (!spirv)
+			shaders.Add(name, "res/shaders/Basic.shader");
+		else if (i % 2)
+			shaders.AddSpirv(name, dir + "/Basic.vert.spv", dir + "/Basic.frag.spv", {}, { { 0, GL_POINTS } });
+		else
+			shaders.AddSpirv(name, dir + "/Basic.vert.spv", dir + "/Basic.frag.spv");
+	}
+	shaders.Build();
+	for (int i = 0; i < programs; i++)
+		if (!shaders.Get("Basic" + std::to_string(i)))
+			return -1.0;
+	return timer.ElapsedMs();
+}
+
+static bool report(const char* name, int programs, bool spirv, const std::string& dir) {
+	std::vector<double> timesMs;
+	for (int i = 0; i < ITERATIONS; i++) {
+		double ms = buildPrograms(programs, spirv, dir);
+		if (ms < 0.0) {
+			std::cout << "spirv: cannot build the " << name << " programs" << std::endl;
+			return false;
+		}
+		timesMs.push_back(ms);
+	}
+	double best = *std::min_element(timesMs.begin(), timesMs.end());
+	std::cout << "  " << name << ": best " << best << " ms, " << best / programs << " ms/program" << std::endl;
+	return true;
+}
+
+int SpirvBench(int argc, char** argv) {
+	int programs = argc > 0 ? atoi(argv[0]) : 50;
+	std::string dir = argc > 1 ? argv[1] : "res/shaders/spirv";
+	if (programs <= 0) {
+		std::cout << "spirv: program count must be positive" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	GLFWwindow* window = CreateBenchContext();
+	if (!window)
+		return EXIT_FAILURE;
+
+	std::cout << "spirv: " << programs << " programs, " << ITERATIONS << " iterations" << std::endl;
+	bool ok = report("GLSL ", programs, false, dir);
+	if (!std::filesystem::exists(dir + "/Basic.vert.spv") || !std::filesystem::exists(dir + "/Basic.frag.spv")) {
+		std::cout << "spirv: no Basic.vert.spv and Basic.frag.spv in " << dir << "; compile them with "
+			"glslangValidator -G -o Basic.vert.spv Basic.vert (and the same for Basic.frag)" << std::endl;
+		ok = false;
+	}
+	else if (!GLEW_VERSION_4_6 && !GLEW_ARB_gl_spirv) {
+		std::cout << "spirv: the context supports neither OpenGL 4.6 nor ARB_gl_spirv" << std::endl;
+		ok = false;
+	}
+	else {
+		ok = report("SPIR-V", programs, true, dir) && ok;
+	}
+
+	DestroyBenchContext(window);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,21 +1,32 @@
 #shader vertex
 #version 460 core
+#include "Params.glsl"
 
 layout(location = 0) in vec4 position;
+#ifdef INSTANCED
+layout(location = 1) in vec2 offset;  // per instance, attribute divisor 1
+#endif
+flat out uint v_Object;
 
 void main()
 {
-     gl_Position = position;
+#ifdef INSTANCED
+     gl_Position = u_View.ViewProjection * (position + vec4(offset, 0.0, 0.0));
+#else
+     gl_Position = u_View.ViewProjection * position;
+#endif
+     v_Object = gl_BaseInstance;  // each draw passes its object index as the base instance
 };
 
 #shader fragment
 #version 460 core
+#include "Params.glsl"
 
 layout(location = 0) out vec4 color;
 
-uniform vec4 u_Color;
+flat in uint v_Object;
 
 void main()
 {
-    color = u_Color;
-};
\ No newline at end of file
+    color = u_Objects[v_Object].Color;
+};
@@ -0,0 +1,37 @@
+#shader vertex
+#version 460 core
+
+/* one instance per quad; the four corners come from gl_VertexID */
+layout(location = 0) in vec4 a_Rect;    // x, y, width, height in pixels from the top left
+layout(location = 1) in uint a_Glyph;   // cell in the 16 x 8 glyph atlas
+layout(location = 2) in vec4 a_Color;
+
+uniform vec4 u_Screen;                  // framebuffer width, height
+
+out vec2 v_Texel;
+flat out vec4 v_Color;
+
+void main()
+{
+     vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+     vec2 pixel = a_Rect.xy + corner * a_Rect.zw;
+     gl_Position = vec4(pixel.x / u_Screen.x * 2.0 - 1.0, 1.0 - pixel.y / u_Screen.y * 2.0, 0.0, 1.0);
+     v_Texel = (vec2(a_Glyph % 16u, a_Glyph / 16u) + corner) * 8.0;
+     v_Color = a_Color;
+};
+
+#shader fragment
+#version 460 core
+
+layout(location = 0) out vec4 color;
+layout(binding = 0) uniform sampler2D u_Atlas;
+
+in vec2 v_Texel;
+flat in vec4 v_Color;
+
+void main()
+{
+    if (texelFetch(u_Atlas, ivec2(v_Texel), 0).r < 0.5)
+        discard;
+    color = v_Color;
+};
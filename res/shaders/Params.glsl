@@ -0,0 +1,24 @@
+// Parameter blocks shared by all shaders; mirrored in src/ShaderParams.h.
+
+layout(std140, binding = 0) uniform FrameParams
+{
+    float Time;
+    float DeltaTime;
+    uint FrameIndex;
+} u_Frame;
+
+layout(std140, binding = 1) uniform ViewParams
+{
+    mat4 ViewProjection;
+    vec4 Viewport;
+} u_View;
+
+struct ObjectData
+{
+    vec4 Color;
+};
+
+layout(std430, binding = 2) readonly buffer ObjectParams
+{
+    ObjectData u_Objects[];
+};
@@ -0,0 +1,26 @@
+#version 460 core
+// GLSL source of Basic.frag.spv; compile with: glslangValidator -G -o Basic.frag.spv Basic.frag
+
+// Specialized at load time: 0 = GL_POINTS draws round points, anything else draws flat.
+// The branch on a specialization constant is folded away by the driver.
+layout(constant_id = 0) const uint PRIMITIVE = 4;
+
+struct ObjectData
+{
+    vec4 Color;
+};
+
+layout(std430, binding = 2) readonly buffer ObjectParams
+{
+    ObjectData u_Objects[];
+};
+
+layout(location = 0) flat in uint v_Object;
+layout(location = 0) out vec4 color;
+
+void main()
+{
+    if (PRIMITIVE == 0 && length(gl_PointCoord - vec2(0.5)) > 0.5)
+        discard;
+    color = u_Objects[v_Object].Color;
+}
@@ -0,0 +1,17 @@
+#version 460 core
+// GLSL source of Basic.vert.spv; compile with: glslangValidator -G -o Basic.vert.spv Basic.vert
+
+layout(std140, binding = 1) uniform ViewParams
+{
+    mat4 ViewProjection;
+    vec4 Viewport;
+} u_View;
+
+layout(location = 0) in vec4 position;
+layout(location = 0) flat out uint v_Object;
+
+void main()
+{
+     gl_Position = u_View.ViewProjection * position;
+     v_Object = gl_BaseInstance;
+}
@@ -0,0 +1,18 @@
+#shader vertex
+#version 460 core
+#include "../Params.glsl"
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+    float gl_PointSize;
+};
+
+layout(location = 0) in vec4 position;
+layout(location = 0) flat out uint v_Object;
+
+void main()
+{
+     gl_Position = u_View.ViewProjection * position;
+     v_Object = gl_BaseInstance;
+};
\ No newline at end of file
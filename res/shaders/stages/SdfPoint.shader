@@ -0,0 +1,16 @@
+#shader fragment
+#version 460 core
+#include "../Params.glsl"
+
+layout(location = 0) flat in uint v_Object;
+layout(location = 0) out vec4 color;
+
+// round points from the distance to the point center; replaces GL_POINT_SMOOTH,
+// which does not exist in the core profile
+void main()
+{
+    float distance = length(gl_PointCoord - vec2(0.5));
+    if (distance > 0.5)
+        discard;
+    color = u_Objects[v_Object].Color;
+};
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+#include <iostream>
+#include <new>
+
+namespace {
+	/* plain integers, so they are constant-initialized and safe to touch from inside operator new */
+	thread_local uint64_t allocationCount = 0;
+	thread_local uint64_t allocationBytes = 0;
+	std::atomic<uint64_t> violations(0);
+
+	void* allocate(size_t size)
+	{
+		allocationCount++;
+		allocationBytes += size;
+		return malloc(size ? size : 1);
+	}
+
+	/* alignas(64) types and SceneStore's arrays come through here */
+	void* allocateAligned(size_t size, std::align_val_t alignment)
+	{
+		allocationCount++;
+		allocationBytes += size;
+		size_t align = (size_t)alignment;
+#ifdef _MSC_VER
+		return _aligned_malloc(size ? size : 1, align);
+#else
+		/* aligned_alloc() wants a multiple of the alignment */
+		return aligned_alloc(align, size ? (size + align - 1) / align * align : align);
+#endif
+	}
+
+	void freeAligned(void* p)
+	{
+#ifdef _MSC_VER
+		_aligned_free(p);
+#else
+		free(p);
+#endif
+	}
+}
+
+std::atomic<bool> AllocationTracker::s_Checking(false);
+
+uint64_t AllocationTracker::Count()
+{
+	return allocationCount;
+}
+
+uint64_t AllocationTracker::Bytes()
+{
+	return allocationBytes;
+}
+
+uint64_t AllocationTracker::Violations()
+{
+	return violations.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::ReportViolation(const char* name, uint64_t count, uint64_t bytes)
+{
+	violations.fetch_add(1, std::memory_order_relaxed);
+	std::cout << "Error:  " << count << " heap allocation(s), " << bytes << " bytes, in " << name << std::endl;
+}
+
+void* operator new(size_t size)
+{
+	if (void* p = allocate(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (void* p = allocate(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* p = allocateAligned(size, alignment))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	if (void* p = allocateAligned(size, alignment))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	freeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	freeAligned(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+	freeAligned(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+	freeAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	freeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	freeAligned(p);
+}
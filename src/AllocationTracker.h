@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Heap allocation counters.  AllocationTracker.cpp replaces the global
+ * operator new/delete, over-aligned forms included, so every allocation made
+ * through new (including the standard containers and std::string) is counted
+ * for the thread that made it.
+ * Memory the GL driver takes with malloc is not seen.
+ */
+class AllocationTracker
+{
+private:
+	static std::atomic<bool> s_Checking;
+public:
+	/* named AllocationScopes only report while checking is on, which skips warm-up
+	   work such as a driver compiling shader variants on first use */
+	static bool IsChecking() { return s_Checking.load(std::memory_order_relaxed); }
+	static void SetChecking(bool checking) { s_Checking.store(checking, std::memory_order_relaxed); }
+
+	/* allocations and bytes requested by the calling thread since it started */
+	static uint64_t Count();
+	static uint64_t Bytes();
+	/* AllocationScopes with a name that ended with allocations, on any thread */
+	static uint64_t Violations();
+	static void ReportViolation(const char* name, uint64_t count, uint64_t bytes);
+};
+
+/* counts the calling thread's allocations in the rest of the enclosing block */
+class AllocationScope
+{
+private:
+	const char* m_Name;
+	uint64_t m_Count;
+	uint64_t m_Bytes;
+public:
+	/* with a name, any allocation is reported as an error when the scope ends, while checking is on */
+	explicit AllocationScope(const char* name = nullptr)
+		: m_Name(name && AllocationTracker::IsChecking() ? name : nullptr), m_Count(AllocationTracker::Count()), m_Bytes(AllocationTracker::Bytes()) {}
+	~AllocationScope()
+	{
+		if (m_Name && Allocations())
+			AllocationTracker::ReportViolation(m_Name, Allocations(), AllocatedBytes());
+	}
+
+	uint64_t Allocations() const { return AllocationTracker::Count() - m_Count; }
+	uint64_t AllocatedBytes() const { return AllocationTracker::Bytes() - m_Bytes; }
+};
+
+#define ALLOC_SCOPE_CONCAT2(a, b) a##b
+#define ALLOC_SCOPE_CONCAT(a, b) ALLOC_SCOPE_CONCAT2(a, b)
+/* the rest of the enclosing block must not allocate on the heap (see AllocationTracker::SetChecking) */
+#define ASSERT_NO_ALLOC(name) AllocationScope ALLOC_SCOPE_CONCAT(allocScope, __LINE__)(name)
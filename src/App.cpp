@@ -0,0 +1,730 @@
+#include "App.h"
+#include "Renderer.h"
+#include "SceneStore.h"
+#include "Shader.h"
+#include "ShaderLibrary.h"
+#include "ParameterBuffer.h"
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "Hud.h"
+#include "FrameBuffer.h"
+#include "AllocationTracker.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static const int modes[App::MODE_COUNT] =
+{
+	GL_POINTS,
+	GL_LINES,
+	GL_LINE_STRIP,
+	GL_LINE_LOOP,
+	GL_TRIANGLES
+};
+
+static const double STATS_SECONDS = 10; // frame stats are logged this often
+static const int BENCH_WIDTH = 640;     // size of the offscreen benchmark target
+static const int BENCH_HEIGHT = 480;
+static const size_t FRAME_ARENA_BYTES = 64 * 1024; // transient data per frame, see FrameArena::Report()
+static const int ALLOC_WARMUP_FRAMES = 16; // frames RunAllocCheck() lets caches and profilers fill first
+static const unsigned int SCENE_CAPACITY = 64;    // entities
+
+/* Normalize lower left screen coordinate system (0 to 3) to center screen coordinate system (-1 to +1)*/
+static float n(float x) 
+{
+	float normal = 2 * (((x - 0) / (3 - 0))) - 1;
+	return normal;
+}
+
+static const char* modeName(int mode) {
+	switch (mode) {
+		case GL_POINTS:     return "points";
+		case GL_LINES:      return "lines";
+		case GL_LINE_STRIP: return "line_strip";
+		case GL_LINE_LOOP:  return "line_loop";
+		case GL_TRIANGLES:  return "triangles";
+	}
+	return "unknown";
+}
+
+/* primitives the draws of a frame assembled, from the vertex and draw counts */
+static unsigned long long primitiveCount(int mode, const RenderStats& stats) {
+	switch (mode) {
+		case GL_POINTS:     return stats.Vertices;
+		case GL_LINES:      return stats.Vertices / 2;
+		case GL_LINE_STRIP: return stats.Vertices - stats.DrawCalls;
+		case GL_LINE_LOOP:  return stats.Vertices;
+		case GL_TRIANGLES:  return stats.Vertices / 3;
+	}
+	return 0;
+}
+
+
+App::App(const AppConfig& config)
+	: m_Config(config), m_Window(nullptr), m_Pacer(config.Pacing, config.Rate), m_VertexArray(0), m_Shaders(nullptr),
+	m_Shader(nullptr), m_PointPipeline(nullptr), m_Scene(nullptr), m_Params(nullptr), m_GpuProfiler(nullptr),
+	m_FrameStats(nullptr), m_Hud(nullptr), m_FrameArena(nullptr), m_Commands(nullptr),
+	m_Versions(nullptr), m_VersionReader(nullptr), m_ProducerEntities(0), m_EditorEntities(0), m_Valid(false),
+	m_Input(), m_ModeIndex(1), m_SceneDirty(true), m_IdleSeconds(0.0), m_SkippedFrames(0), m_RefreshRate(60), m_Mode(0), m_ViewportWidth(0),
+	m_ViewportHeight(0), m_CpuMs(0.0)
+{
+	m_Window = CreateGlWindow(m_Config.Width, m_Config.Height, m_Config.Visible);
+	if (!m_Window)
+		return;
+	m_Pacer.Apply();
+
+	/* the callbacks find their app through the window */
+	glfwSetWindowUserPointer(m_Window, this);
+	glfwSetKeyCallback(m_Window, KeyCallback);
+	glfwSetWindowRefreshCallback(m_Window, RefreshCallback);
+	glfwSetFramebufferSizeCallback(m_Window, FramebufferSizeCallback);
+
+	std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+	std::cout << "OpenGL Vendor : " << glGetString(GL_VENDOR) << std::endl;
+
+	glPointSize(3);
+	glLineWidth(3);
+	// Round points come from the SdfPoint fragment stage; GL_POINT_SMOOTH is not part of the core profile
+
+	GlCall(glGenVertexArrays(1, &m_VertexArray));
+	GlCall(glBindVertexArray(m_VertexArray));
+
+	/* alloc the array and index buffers in the GPU */
+	m_Scene = new SceneStore(SCENE_CAPACITY);
+	BuildScene();
+
+	/* Compile the Shader source code; every program in the library is built in one batch */
+	m_Shaders = new ShaderLibrary();
+	m_Shaders->Add("Basic", "res/shaders/Basic.shader");
+	m_Shaders->AddStage("Plain", "res/shaders/stages/Plain.shader");
+	m_Shaders->AddStage("SdfPoint", "res/shaders/stages/SdfPoint.shader");
+	m_Shaders->Add("Hud", "res/shaders/Hud.shader");
+	m_Shaders->Build();
+
+	m_Shader = m_Shaders->Get("Basic");
+	m_PointPipeline = m_Shaders->GetPipeline("Plain", "SdfPoint");
+	Shader* hudShader = m_Shaders->Get("Hud");
+	if (!m_Shader || !m_PointPipeline || !hudShader) {
+		glfwMakeContextCurrent(NULL);
+		return;
+	}
+	m_Shader->Bind();
+
+	/* all shader parameters live in one buffer that is uploaded at most once per frame */
+	m_Params = new ParameterBuffer(m_Scene->Count());
+	if (!m_Params->Validate(*m_Shader)) {
+		glfwMakeContextCurrent(NULL);
+		return;
+	}
+	SetupParams();
+	m_Params->Bind();
+
+	m_GpuProfiler = new GpuProfiler();
+	m_FrameStats = new FrameStats(STATS_SECONDS);
+	m_Hud = new Hud(*hudShader);
+	m_FrameArena = new FrameArena(FRAME_ARENA_BYTES);
+	m_Commands = new RenderCommandQueue(m_Config.QueuePolicy);
+	if (m_Config.Editor)
+		m_Versions = new SceneVersions(EDITOR_BARS, { { 1.0, 1.0, 1.0, 1.0 } });
+	m_Input.Mode = m_Mode;
+	m_Input.HudVisible = m_Hud->Visible();
+
+	GlCall(glEnableVertexAttribArray(0));
+
+	/* whichever thread draws makes the context current */
+	glfwMakeContextCurrent(NULL);
+	m_Valid = true;
+}
+
+App::~App()
+{
+	if (!m_Window)
+		return;
+	glfwMakeContextCurrent(m_Window);
+	delete m_Versions;
+	delete m_Commands;
+	delete m_FrameArena;
+	delete m_Hud;
+	delete m_Scene;
+	delete m_FrameStats;
+	delete m_GpuProfiler;
+	delete m_Params;
+	delete m_Shaders;
+	if (m_VertexArray)
+		glDeleteVertexArrays(1, &m_VertexArray);
+	glfwMakeContextCurrent(NULL);
+	glfwDestroyWindow(m_Window);
+}
+
+/* Fills the scene store with the book's figures and uploads them; an entity's ID is also its ObjectParams slot.
+   Each producer thread gets a lines and a points entity to update through the render command queue,
+   and the editor gets its bars. */
+void App::BuildScene()
+{
+	const float points[] = 
+	{ 
+		n(1.0f), n(1.0f), 
+		n(2.0f), n(1.0f), 
+		n(2.0f), n(2.0f) 
+	};
+
+	const float lines[] = 
+	{ 
+		n(0.5f), n(1.0f), 
+		n(2.0f), n(2.0f), 
+		n(1.8f), n(2.6f), 
+		n(0.7f), n(2.2f), 
+		n(1.6f), n(1.2f), 
+		n(1.0f), n(0.5f) 
+	};
+
+	const float t1[] = 
+	{
+		n(0.3f),   n(1.0f),   n(0.5f),
+		n(2.7f),   n(0.85f),  n(0.0f),
+		n(2.7f),   n(1.15f),  n(0.0f)
+	};
+	const float t2[] = 
+	{
+		n(2.53f),  n(0.71f),  n(0.5f),
+		n(1.46f),  n(2.86f),  n(0.0f),
+		n(1.2f),   n(2.71f),  n(0.0f)
+	};
+	const float t3[] = 
+	{
+		n(1.667f), n(2.79f),  n(0.5f),
+		n(0.337f), n(0.786f), n(0.0f),
+		n(0.597f), n(0.636f), n(0.0f)
+	};
+
+	m_Scene->Add(SceneStore::KIND_POINTS, points, 3, 2, { { 1.0, 0.0, 0.0, 1.0 } });  // red
+	m_Scene->Add(SceneStore::KIND_LINES, lines, 6, 2, { { 1.0, 0.0, 0.0, 1.0 } });    // red
+	m_Scene->Add(SceneStore::KIND_TRIANGLES, t1, 3, 3, { { 1.0, 0.0, 0.0, 1.0 } });   // red
+	m_Scene->Add(SceneStore::KIND_TRIANGLES, t2, 3, 3, { { 0.0, 1.0, 0.0, 1.0 } });   // green
+	m_Scene->Add(SceneStore::KIND_TRIANGLES, t3, 3, 3, { { 0.0, 0.0, 1.0, 1.0 } });   // blue
+
+	m_ProducerEntities = m_Scene->Count();
+	for (int i = 0; i < m_Config.Producers; i++) {
+		m_Scene->Reserve(SceneStore::KIND_LINES, PRODUCER_VERTICES, { { 1.0, 1.0, 0.0, 1.0 } });   // yellow
+		m_Scene->Reserve(SceneStore::KIND_POINTS, PRODUCER_VERTICES, { { 1.0, 1.0, 1.0, 1.0 } });  // white
+	}
+	m_EditorEntities = m_Scene->Count();
+	for (unsigned int i = 0; m_Config.Editor && i < EDITOR_BARS; i++)
+		m_Scene->Reserve(SceneStore::KIND_LINES, SceneVersions::MAX_VERTICES, { { 1.0, 1.0, 1.0, 1.0 } });
+	m_Scene->Upload();
+}
+
+void App::SetupParams()
+{
+	ViewParams view = {};
+	view.ViewProjection[0] = view.ViewProjection[5] = view.ViewProjection[10] = view.ViewProjection[15] = 1.0f;
+	view.Viewport[2] = (float)m_Config.Width;
+	view.Viewport[3] = (float)m_Config.Height;
+	m_Params->SetView(view);
+	m_Scene->WriteParams(*m_Params);
+}
+
+/*
+ * DrawScene() handles the animation and the redrawing of the
+ *		graphics window contents.
+ */
+void App::DrawScene()
+{
+	PROFILE_FUNCTION();
+	ASSERT_NO_ALLOC("drawScene");
+
+	/* visibility, then batch building; both passes stream through the scene store's arrays */
+	/* a few dozen entities are far below SceneStore::CULL_GRAIN, so culling stays on this thread */
+	m_Scene->Cull(-1.0f, -1.0f, 1.0f, 1.0f);  // clip space, the view is the identity
+
+	const char* scope = "";
+	SceneStore::Kind kind = SceneStore::KIND_POINTS;
+	switch (m_Mode) {
+		case GL_POINTS:
+			scope = "points";
+			kind = SceneStore::KIND_POINTS;
+			break;
+		case GL_LINES:
+		case GL_LINE_STRIP:
+		case GL_LINE_LOOP:
+			scope = "lines";
+			kind = SceneStore::KIND_LINES;
+			break;
+		case GL_TRIANGLES:
+			scope = "triangles";
+			kind = SceneStore::KIND_TRIANGLES;
+			break;
+	}
+
+	/* the draws are recorded into the frame arena and issued in one pass; they all share the store's buffers, so entity order needs no sorting */
+	CommandList commands{ ArenaAllocator<DrawCommand>(*m_FrameArena) };
+	commands.reserve(m_Scene->Count());
+	m_Scene->Record(commands, kind, m_Mode);
+
+	GPU_SCOPE(*m_GpuProfiler, scope);
+	if (m_Mode == GL_POINTS)
+		m_PointPipeline->Bind();
+	Submit(commands);
+	if (m_Mode == GL_POINTS)
+		m_Shader->Bind();
+}
+
+/* The drawing thread takes the context, and reads the scene versions too. */
+void App::BeginDrawing()
+{
+	glfwMakeContextCurrent(m_Window);
+	if (m_Versions)
+		m_VersionReader = new SceneVersions::Reader(*m_Versions);
+}
+
+void App::EndDrawing()
+{
+	delete m_VersionReader;
+	m_VersionReader = nullptr;
+	glfwMakeContextCurrent(NULL);
+}
+
+/* Anything that changes what is on screen calls this; in on-demand mode the loop only draws dirty frames. */
+void App::MarkDirty()
+{
+	m_SceneDirty = true;
+}
+
+/* the first event of a frame starts its input-to-present latency */
+void App::InputArrived()
+{
+	if (!m_Input.InputPending) {
+		m_Input.InputPending = true;
+		m_Input.InputTime = FrameStats::Clock::now();
+	}
+}
+
+void App::OnKey(int key, int action)
+{
+	if (action != GLFW_PRESS)
+		return;
+	InputArrived();
+
+	switch (key) {
+		case GLFW_KEY_SPACE:
+			m_ModeIndex = m_ModeIndex % A_LENGTH(modes);
+			m_Input.Mode = modes[m_ModeIndex];
+			m_ModeIndex += 1;
+			MarkDirty();
+			break;
+
+		case GLFW_KEY_H:
+			m_Input.HudVisible = !m_Input.HudVisible;
+			MarkDirty();
+			break;
+
+		case GLFW_KEY_F12:
+			m_Input.CaptureFrames = TRACE_FRAMES;
+			MarkDirty();
+			break;
+
+		case GLFW_KEY_ESCAPE:
+			std::cout << "Goodbye!" << std::endl;
+			glfwSetWindowShouldClose(m_Window, GL_TRUE); // Run() ends and the owner cleans up
+			break;
+	}
+}
+
+void App::KeyCallback(GLFWwindow* window, int key, int, int action, int)
+{
+	static_cast<App*>(glfwGetWindowUserPointer(window))->OnKey(key, action);
+}
+
+void App::RefreshCallback(GLFWwindow* window)
+{
+	static_cast<App*>(glfwGetWindowUserPointer(window))->MarkDirty();
+}
+
+/* the render thread resizes the viewport when the snapshot's size changes */
+void App::FramebufferSizeCallback(GLFWwindow* window, int, int)
+{
+	App* app = static_cast<App*>(glfwGetWindowUserPointer(window));
+	app->InputArrived();
+	app->MarkDirty();
+}
+
+/* Main thread: the next frame's snapshot from the input handled so far. */
+App::FrameSnapshot App::TakeSnapshot()
+{
+	PROFILE_FUNCTION();
+	ASSERT_NO_ALLOC("takeSnapshot");
+	double now = glfwGetTime();
+	m_Input.Frame.DeltaTime = (float)now - m_Input.Frame.Time;
+	m_Input.Frame.Time = (float)now;
+	m_Input.Frame.FrameIndex++;
+	glfwGetFramebufferSize(m_Window, &m_Input.Width, &m_Input.Height);
+
+	FrameSnapshot snapshot = m_Input;
+	m_Input.InputPending = false;
+	m_Input.CaptureFrames = 0;
+	m_Input.Resume = false;
+	return snapshot;
+}
+
+/* One frame from a snapshot: update, draw, overlay, swap and pace.  Runs on the thread that owns the context. */
+void App::RenderFrame(const FrameSnapshot& snapshot)
+{
+	PROFILE_SCOPE("frame");
+	FrameStats::Clock::time_point frameStart = FrameStats::Clock::now();
+	if (snapshot.CaptureFrames > 0)
+		Profiler::Capture(snapshot.CaptureFrames, "trace.json");
+	{
+		PROFILE_SCOPE("update params");
+		ASSERT_NO_ALLOC("update params");
+		m_Mode = snapshot.Mode;
+		if (m_Hud->Visible() != snapshot.HudVisible)
+			m_Hud->Toggle();
+		if (snapshot.Width != m_ViewportWidth || snapshot.Height != m_ViewportHeight) {
+			m_ViewportWidth = snapshot.Width;
+			m_ViewportHeight = snapshot.Height;
+			GlCall(glViewport(0, 0, m_ViewportWidth, m_ViewportHeight));
+		}
+		if (snapshot.InputPending)
+			m_FrameStats->InputArrived(snapshot.InputTime);
+		if (snapshot.Resume)
+			m_Pacer.Resume();
+		m_Commands->Drain(*m_Scene, *m_Params);
+		/* the newest published edit, all of it; the version stays held until the frame is done */
+		if (m_VersionReader)
+			m_VersionReader->Apply(m_VersionReader->Acquire(), *m_Scene, *m_Params, m_EditorEntities);
+
+		m_FrameArena->BeginFrame();
+		m_Params->SetFrame(snapshot.Frame);
+		m_GpuProfiler->BeginFrame();
+
+		/* the overlay shows the previous frame's counters; this frame's start from zero */
+		Hud::FrameInfo info = { snapshot.Frame.DeltaTime * 1000.0, m_CpuMs, m_GpuProfiler->LastFrameMs(), g_RenderStats };
+		g_RenderStats = {};
+		m_Hud->Update(info);
+		m_Params->Flush();
+	}
+
+	/* Render here */
+	{
+		GPU_SCOPE(*m_GpuProfiler, "clear");
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+
+	/* draw the scene as the snapshot left it */
+	DrawScene();
+
+	{
+		PROFILE_SCOPE("hud");
+		GPU_SCOPE(*m_GpuProfiler, "hud");
+		ASSERT_NO_ALLOC("hud");
+		m_Hud->Draw(snapshot.Width, snapshot.Height);
+	}
+
+	/* Swap front and back buffers */
+	FrameStats::Clock::time_point swapStart = FrameStats::Clock::now();
+	{
+		PROFILE_SCOPE("swap");
+		GPU_SCOPE(*m_GpuProfiler, "present");
+		glfwSwapBuffers(m_Window);
+	}
+	FrameStats::Clock::time_point swapEnd = FrameStats::Clock::now();
+	uint64_t frameIndex = snapshot.Frame.FrameIndex;
+	m_FrameStats->Record(FrameStats::CPU_FRAME, frameIndex, swapStart - frameStart);
+	m_CpuMs = std::chrono::duration<double, std::milli>(swapStart - frameStart).count();
+	m_FrameStats->Record(FrameStats::SWAP, frameIndex, swapEnd - swapStart);
+	m_FrameStats->Presented(frameIndex, swapEnd);
+	m_FrameStats->Update(swapEnd);
+	if (m_VersionReader)
+		m_VersionReader->Release();
+
+	/* Hold the frame until its deadline when a frame limit is set */
+	{
+		PROFILE_SCOPE("pace");
+		m_Pacer.EndFrame();
+	}
+}
+
+/* A whole frame on this thread, for the checks that run without a render thread. */
+void App::RunFrame()
+{
+	RenderFrame(TakeSnapshot());
+	{
+		PROFILE_SCOPE("poll events");
+		glfwPollEvents();
+	}
+}
+
+/* The render thread owns the context while Run() loops and draws the snapshots the main thread queues. */
+void App::RenderLoop(SnapshotQueue* snapshots)
+{
+	Profiler::SetThreadName("render");
+	BeginDrawing();
+
+	FrameSnapshot snapshot;
+	for (;;) {
+		{
+			PROFILE_SCOPE("wait for snapshot");
+			snapshots->Pop(snapshot);
+		}
+		/* a slot is free again; wakes the main thread if it waits for one */
+		glfwPostEmptyEvent();
+		if (snapshot.Quit)
+			break;
+		RenderFrame(snapshot);
+		Profiler::EndFrame();
+	}
+
+	EndDrawing();
+}
+
+/*
+ * The interactive loop.  This thread handles input and builds each frame's
+ * snapshot while the render thread draws the previous one, so a swap blocked on
+ * vsync never holds up event handling.
+ */
+void App::Run()
+{
+	SnapshotQueue snapshots;
+	std::thread renderThread(&App::RenderLoop, this, &snapshots);
+	uint64_t drawnVersion = 0;
+	double idleStart = -1.0;     // start of the current idle stretch, < 0 while drawing
+	const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	if (videoMode && videoMode->refreshRate > 0)
+		m_RefreshRate = videoMode->refreshRate;
+
+	while (!glfwWindowShouldClose(m_Window)) {
+		/* Nothing changed: sleep until an event arrives.  The timeout bounds how long
+		   a change that did not come through GLFW waits to be noticed. */
+		bool edited = m_Versions && m_Versions->Published() != drawnVersion;
+		if (m_Config.OnDemand && !m_SceneDirty && !edited && m_Commands->Size() == 0) {
+			if (idleStart < 0.0)
+				idleStart = glfwGetTime();
+			glfwWaitEventsTimeout(0.25);
+			m_Input.Resume = true;   // whichever frame comes next follows an idle stretch
+			continue;
+		}
+		if (idleStart >= 0.0) {
+			EndIdle(idleStart);
+			idleStart = -1.0;
+		}
+
+		/* The render thread is still behind: keep handling events until it takes a snapshot. */
+		if (snapshots.Full()) {
+			PROFILE_SCOPE("wait for render");
+			glfwWaitEvents();
+			continue;
+		}
+		m_SceneDirty = false;
+		if (m_Versions)
+			drawnVersion = m_Versions->Published();
+		snapshots.TryPush(TakeSnapshot());
+
+		/* Poll for and process events */
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	if (idleStart >= 0.0)
+		EndIdle(idleStart);
+
+	/* producers blocked on a full queue would wait for a drain that never comes */
+	m_Commands->Close();
+
+	FrameSnapshot quit = {};
+	quit.Quit = true;
+	while (!snapshots.TryPush(quit))
+		glfwWaitEvents();
+	renderThread.join();
+}
+
+void App::Report() const
+{
+	m_Pacer.Report();
+	m_GpuProfiler->Report();
+	m_FrameStats->Report();
+	m_FrameArena->Report();
+	m_Commands->Report();
+	if (m_Versions)
+		std::cout << "Scene versions: " << m_Versions->Published() << " published, " << m_Versions->Reclaimed()
+			<< " reclaimed, " << m_Versions->Retired() << " held by a frame at the last publish" << std::endl;
+	m_FrameStats->WriteJson("frame_stats.json");
+	if (m_Config.OnDemand)
+		std::cout << "On-demand: skipped " << m_SkippedFrames << " vsync intervals (" << m_IdleSeconds << " s idle at "
+			<< m_RefreshRate << " Hz)" << std::endl;
+}
+
+/* counts the vsync intervals that passed without a frame since the loop went idle */
+void App::EndIdle(double idleStart)
+{
+	double idle = glfwGetTime() - idleStart;
+	m_IdleSeconds += idle;
+	m_SkippedFrames += (uint64_t)(idle * m_RefreshRate);
+}
+
+void App::BenchmarkFrame()
+{
+	m_FrameArena->BeginFrame();
+	m_GpuProfiler->BeginFrame();
+	GPU_SCOPE(*m_GpuProfiler, "frame");
+	glClear(GL_COLOR_BUFFER_BIT);
+	DrawScene();
+}
+
+/*
+ * Draws each of modes[] for a fixed number of frames into an offscreen
+ * framebuffer.  Nothing is swapped, so vsync never holds a frame back;
+ * glFinish() before the clock stops makes the time include the GPU work.
+ */
+int App::RunBenchmark(int frames, const std::string& outPath, const std::function<void()>& ready)
+{
+	BeginDrawing();
+	int status = Benchmark(frames, outPath, ready);
+	EndDrawing();
+	return status;
+}
+
+/*
+ * Runs frames through every mode with the overlay shown and fails if this
+ * thread allocates on the heap once the warm-up is over.  Input handling and
+ * drawing both run here, so both are checked.
+ */
+int App::RunAllocCheck(int frames)
+{
+	BeginDrawing();
+	int status = AllocCheck(frames);
+	EndDrawing();
+	return status;
+}
+
+int App::Benchmark(int frames, const std::string& outPath, const std::function<void()>& ready)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	FrameBuffer target(BENCH_WIDTH, BENCH_HEIGHT);
+	if (!target.IsComplete()) {
+		std::cout << "Error:  benchmark framebuffer is incomplete" << std::endl;
+		return EXIT_FAILURE;
+	}
+	target.Bind();
+	m_Params->Flush();
+
+	std::ofstream out(outPath);
+	if (!out) {
+		std::cout << "Error:  cannot write " << outPath << std::endl;
+		return EXIT_FAILURE;
+	}
+	out << "{\n  \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n  \"version\": \"" << glGetString(GL_VERSION)
+		<< "\",\n  \"width\": " << BENCH_WIDTH << ",\n  \"height\": " << BENCH_HEIGHT << ",\n  \"frames\": " << frames
+		<< ",\n  \"modes\": [\n";
+
+	/* with several renderers running, each line is written in one piece so the output does not interleave */
+	std::string label = m_Config.Name.empty() ? "Benchmark " : "Benchmark (" + m_Config.Name + ") ";
+	int warmup = frames / 10 > 0 ? frames / 10 : 1;
+	if (ready)
+		ready();
+	for (size_t m = 0; m < A_LENGTH(modes); m++) {
+		m_Mode = modes[m];
+		for (int i = 0; i < warmup; i++)
+			BenchmarkFrame();
+		GlCall(glFinish());
+
+		/* a fresh profiler per mode, so the GPU times are this mode's alone */
+		delete m_GpuProfiler;
+		m_GpuProfiler = new GpuProfiler();
+
+		unsigned long long primitives = 0;
+		double submitMs = 0.0;
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < frames; i++) {
+			g_RenderStats = {};
+			Clock::time_point submitStart = Clock::now();
+			BenchmarkFrame();
+			submitMs += std::chrono::duration<double, std::milli>(Clock::now() - submitStart).count();
+			primitives += primitiveCount(m_Mode, g_RenderStats);
+		}
+		GlCall(glFinish());
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		/* collect the frames that were still in flight */
+		for (int i = 0; i < GpuProfiler::FRAMES_IN_FLIGHT; i++)
+			m_GpuProfiler->BeginFrame();
+		const GpuProfiler::ScopeStats* gpu = m_GpuProfiler->GetStats("frame");
+		double gpuMs = gpu && gpu->Count ? gpu->TotalMs / gpu->Count : 0.0;
+		unsigned long long gpuFrames = gpu ? gpu->Count : 0;
+
+		std::ostringstream line;
+		line << label << modeName(m_Mode) << ": " << frames / seconds << " fps, " << primitives / seconds
+			<< " primitives/s, CPU submit " << submitMs / frames << " ms, GPU " << gpuMs << " ms\n";
+		std::cout << line.str() << std::flush;
+		out << "    { \"mode\": \"" << modeName(m_Mode) << "\", \"frames\": " << frames << ", \"seconds\": " << seconds
+			<< ", \"fps\": " << frames / seconds << ", \"primitives_per_frame\": " << primitives / frames
+			<< ", \"primitives_per_sec\": " << primitives / seconds << ", \"cpu_submit_ms\": " << submitMs / frames
+			<< ", \"gpu_ms\": " << gpuMs << ", \"gpu_frames\": " << gpuFrames << " }"
+			<< (m + 1 < A_LENGTH(modes) ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+
+	target.Unbind();
+	std::cout << label + "results written to " + outPath + "\n" << std::flush;
+	return EXIT_SUCCESS;
+}
+
+int App::AllocCheck(int frames)
+{
+	const int MAX_REPORTED = 10;
+
+	/* offscreen like the benchmark, so it also runs where there is no default framebuffer */
+	FrameBuffer target(BENCH_WIDTH, BENCH_HEIGHT);
+	if (!target.IsComplete()) {
+		std::cout << "Error:  allocation check framebuffer is incomplete" << std::endl;
+		return EXIT_FAILURE;
+	}
+	target.Bind();
+
+	m_Input.HudVisible = true;
+
+	/* the first frames of each mode fill the profilers' name tables and the driver's caches */
+	for (size_t m = 0; m < A_LENGTH(modes); m++) {
+		m_Input.Mode = modes[m];
+		for (int i = 0; i < ALLOC_WARMUP_FRAMES; i++) {
+			RunFrame();
+			Profiler::EndFrame();
+		}
+	}
+
+	/* the named scopes in the frame (drawScene, hud) narrow down where a frame allocated */
+	AllocationTracker::SetChecking(true);
+	int failedFrames = 0;
+	uint64_t allocations = 0, bytes = 0;
+	for (int i = 0; i < frames; i++) {
+		m_Input.Mode = modes[i % A_LENGTH(modes)];
+		AllocationScope scope;
+		RunFrame();
+		Profiler::EndFrame();
+
+		uint64_t frameAllocations = scope.Allocations();
+		if (frameAllocations) {
+			allocations += frameAllocations;
+			bytes += scope.AllocatedBytes();
+			if (failedFrames++ < MAX_REPORTED)
+				std::cout << "Error:  frame " << i << " (" << modeName(m_Mode) << ") made " << frameAllocations
+					<< " heap allocation(s), " << scope.AllocatedBytes() << " bytes" << std::endl;
+		}
+	}
+
+	AllocationTracker::SetChecking(false);
+	target.Unbind();
+	m_FrameArena->Report();
+	if (failedFrames) {
+		std::cout << "Allocation check failed: " << failedFrames << " of " << frames << " frames allocated, "
+			<< allocations << " allocation(s), " << bytes << " bytes" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "Allocation check passed: " << frames << " frames after warm-up without a heap allocation" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "RenderCommands.h"
+#include "SceneVersions.h"
+#include "ShaderParams.h"
+#include "SpscQueue.h"
+
+struct GLFWwindow;
+class Shader;
+class ShaderLibrary;
+class ProgramPipeline;
+class ParameterBuffer;
+class SceneStore;
+class GpuProfiler;
+class Hud;
+class FrameArena;
+
+/* How an App is set up; fixed for its lifetime. */
+struct AppConfig
+{
+	std::string Name;                    // prefixes the benchmark output when several apps run
+	int Width = 640;
+	int Height = 480;
+	bool Visible = true;                 // false for the offscreen modes
+	PacingMode Pacing = PacingMode::VSync;
+	double Rate = 0.0;
+	bool OnDemand = false;               // only redraw dirty frames
+	int Producers = 0;                   // threads that get entities to update through Commands()
+	QueueFullPolicy QueuePolicy = QueueFullPolicy::Block;
+	bool Editor = false;                 // scene versions for an editor thread, see Versions()
+};
+
+/*
+ * One window, its GL context and everything drawn with it: the scene, shaders,
+ * parameter buffer, profilers and input state.  Nothing is shared between
+ * apps, so one process can run several, each on its own thread.
+ *
+ * The constructor and destructor use GLFW and must run on the main thread;
+ * the context is not current on any thread in between.  Run() is the
+ * interactive loop and RunAllocCheck() polls events, so both need the main
+ * thread too.  RunBenchmark() draws on the calling thread, whichever it is.
+ */
+class App
+{
+public:
+	static const int TRACE_FRAMES = 120;                 // frames captured by F12
+	static const int MODE_COUNT = 5;                     // drawing modes SPACE cycles through and benchmarks measure
+	static const unsigned int PRODUCER_VERTICES = 12;    // per entity a producer updates
+	static const unsigned int EDITOR_BARS = 32;          // entities in Versions(), two SceneVersions chunks
+private:
+	/*
+	 * Everything the render thread needs from the main thread for one frame.  The
+	 * main thread handles input into the next snapshot while the render thread
+	 * draws the previous one; the one-shot requests are cleared once taken.
+	 */
+	struct FrameSnapshot
+	{
+		FrameParams Frame;
+		int Mode;                  // one of the drawing modes
+		bool HudVisible;
+		int Width, Height;         // framebuffer size
+		bool InputPending;         // an input event arrived for this frame, at InputTime
+		FrameStats::Clock::time_point InputTime;
+		int CaptureFrames;         // > 0 starts a trace capture
+		bool Resume;               // the on-demand loop sat idle before this frame
+		bool Quit;                 // ends the render thread
+	};
+	static const unsigned int QUEUED_FRAMES = 1;   // snapshots the main thread may get ahead of the render thread
+	typedef SpscQueue<FrameSnapshot, QUEUED_FRAMES> SnapshotQueue;
+
+	AppConfig m_Config;
+	GLFWwindow* m_Window;
+	FramePacer m_Pacer;
+	unsigned int m_VertexArray;
+	ShaderLibrary* m_Shaders;
+	Shader* m_Shader;
+	ProgramPipeline* m_PointPipeline;
+	SceneStore* m_Scene;
+	ParameterBuffer* m_Params;
+	GpuProfiler* m_GpuProfiler;
+	FrameStats* m_FrameStats;
+	Hud* m_Hud;
+	FrameArena* m_FrameArena;
+	RenderCommandQueue* m_Commands;              // other threads' updates, drained every frame
+	SceneVersions* m_Versions;                   // the editor's bars, if there is an editor
+	SceneVersions::Reader* m_VersionReader;      // the drawing thread's hold on the version its frame draws
+	unsigned int m_ProducerEntities;             // the first entity reserved for producers
+	unsigned int m_EditorEntities;               // the first entity reserved for the bars
+	bool m_Valid;
+
+	/* main thread: input for the next frame */
+	FrameSnapshot m_Input;
+	int m_ModeIndex;
+	bool m_SceneDirty;
+	double m_IdleSeconds;                        // time the on-demand loop spent waiting instead of drawing
+	uint64_t m_SkippedFrames;                    // whole vsync intervals that passed while it waited
+	int m_RefreshRate;
+
+	/* drawing thread */
+	int m_Mode;
+	int m_ViewportWidth, m_ViewportHeight;
+	double m_CpuMs;
+public:
+	explicit App(const AppConfig& config);
+	~App();
+	App(const App&) = delete;
+	App& operator=(const App&) = delete;
+
+	/* false if the window, context or shaders could not be created; nothing else may be called then */
+	bool IsValid() const { return m_Valid; }
+	const AppConfig& Config() const { return m_Config; }
+
+	/* Main thread: draws on a render thread until the window closes, then closes Commands(). */
+	void Run();
+	/* Main thread, after Run() and once the threads feeding Commands() and Versions() have stopped. */
+	void Report() const;
+	/* Offscreen: every drawing mode for `frames` frames, results written as JSON to outPath.
+	   ready, if given, is called once the target and output file are set up, right before the first frame. */
+	int RunBenchmark(int frames, const std::string& outPath, const std::function<void()>& ready = nullptr);
+	/* Offscreen: fails if a frame allocates on the heap once the warm-up is over. */
+	int RunAllocCheck(int frames);
+
+	RenderCommandQueue& Commands() { return *m_Commands; }
+	SceneVersions* Versions() { return m_Versions; }
+	/* producer i updates a lines entity and the points entity after it */
+	unsigned int ProducerEntity(int producer) const { return m_ProducerEntities + 2 * producer; }
+private:
+	void BuildScene();
+	void SetupParams();
+	void DrawScene();
+	void BenchmarkFrame();
+	void BeginDrawing();
+	void EndDrawing();
+	int Benchmark(int frames, const std::string& outPath, const std::function<void()>& ready);
+	int AllocCheck(int frames);
+
+	void MarkDirty();
+	void InputArrived();
+	void EndIdle(double idleStart);
+	void OnKey(int key, int action);
+	FrameSnapshot TakeSnapshot();
+	void RenderFrame(const FrameSnapshot& snapshot);
+	void RunFrame();
+	void RenderLoop(SnapshotQueue* snapshots);
+
+	static void KeyCallback(GLFWwindow* window, int key, int, int action, int);
+	static void RefreshCallback(GLFWwindow* window);
+	static void FramebufferSizeCallback(GLFWwindow* window, int, int);
+};
@@ -0,0 +1,83 @@
+#include "FrameArena.h"
+#include "Renderer.h"
+
+#include <iostream>
+#include <new>
+
+FrameArena::FrameArena(size_t bytesPerFrame)
+	: m_Memory(static_cast<char*>(::operator new(bytesPerFrame * FRAMES))), m_Capacity(bytesPerFrame),
+	m_Frame(0), m_Offset(0), m_OverflowBytes(0), m_HighWater(0), m_Frames(0), m_OverflowFrames(0)
+{
+	for (Overflow*& overflow : m_Overflows)
+		overflow = nullptr;
+}
+
+FrameArena::~FrameArena()
+{
+	for (int i = 0; i < FRAMES; i++)
+		ReleaseOverflows(i);
+	::operator delete(m_Memory);
+}
+
+void FrameArena::Finish()
+{
+	size_t used = Used();
+	if (used > m_HighWater)
+		m_HighWater = used;
+	if (m_OverflowBytes)
+		m_OverflowFrames++;
+}
+
+void FrameArena::BeginFrame()
+{
+	if (m_Frames++)
+		Finish();
+	m_Frame = (m_Frame + 1) % FRAMES;
+	ReleaseOverflows(m_Frame);
+	m_Offset = 0;
+	m_OverflowBytes = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	ASSERT((alignment & (alignment - 1)) == 0);
+	size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+	if (offset + size <= m_Capacity) {
+		m_Offset = offset + size;
+		return m_Memory + m_Frame * m_Capacity + offset;
+	}
+
+	/* spill: a heap block with room to align, released when this buffer comes round again */
+	size_t header = (sizeof(Overflow) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	size_t blockSize = header + size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+	Overflow* block = static_cast<Overflow*>(::operator new(blockSize));
+	block->Next = m_Overflows[m_Frame];
+	m_Overflows[m_Frame] = block;
+	m_OverflowBytes += size;
+
+	uintptr_t data = reinterpret_cast<uintptr_t>(block) + header;
+	data = (data + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	return reinterpret_cast<void*>(data);
+}
+
+void FrameArena::ReleaseOverflows(int frame)
+{
+	while (Overflow* block = m_Overflows[frame]) {
+		m_Overflows[frame] = block->Next;
+		::operator delete(block);
+	}
+}
+
+size_t FrameArena::HighWater() const
+{
+	return Used() > m_HighWater ? Used() : m_HighWater;
+}
+
+void FrameArena::Report() const
+{
+	std::cout << "Frame arena: peak " << HighWater() << " of " << m_Capacity << " bytes per frame, "
+		<< FRAMES << " frames buffered";
+	if (m_OverflowFrames)
+		std::cout << ", " << m_OverflowFrames << " frames spilled onto the heap";
+	std::cout << std::endl;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Linear allocator for data that lives for one frame: draw command records,
+ * sort keys, staging vertices.  Allocate() bumps an offset and there is no
+ * free; BeginFrame() moves to the next of FRAMES buffers and rewinds it, so
+ * data of the previous frames in flight stays valid while a new one is built.
+ *
+ * A frame that outgrows its buffer spills into heap blocks that are released
+ * when the buffer is reused; HighWater() tells how large the buffers must be to
+ * avoid that.  Not thread-safe: one arena per thread that builds frames.
+ */
+class FrameArena
+{
+public:
+	static const int FRAMES = 3;
+private:
+	struct Overflow
+	{
+		Overflow* Next;
+	};
+
+	char* m_Memory;
+	size_t m_Capacity;        // bytes per frame
+	int m_Frame;              // buffer of the current frame
+	size_t m_Offset;
+	size_t m_OverflowBytes;   // this frame's bytes outside its buffer
+	Overflow* m_Overflows[FRAMES];
+	size_t m_HighWater;       // most bytes any frame used
+	uint64_t m_Frames;
+	uint64_t m_OverflowFrames;
+public:
+	explicit FrameArena(size_t bytesPerFrame);
+	~FrameArena();
+
+	/* O(1) unless the reused buffer spilled onto the heap */
+	void BeginFrame();
+	/* alignment must be a power of two; memory is uninitialized */
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T* Allocate(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+	size_t Used() const { return m_Offset + m_OverflowBytes; }
+	size_t Capacity() const { return m_Capacity; }
+	size_t HighWater() const;
+	uint64_t OverflowFrames() const { return m_OverflowFrames; }
+	void Report() const;
+private:
+	void ReleaseOverflows(int frame);
+	void Finish();
+};
+
+/* STL allocator over a FrameArena; deallocate() is a no-op, the arena resets as a whole */
+template<typename T>
+class ArenaAllocator
+{
+private:
+	FrameArena* m_Arena;
+
+	template<typename U> friend class ArenaAllocator;
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(FrameArena& arena) : m_Arena(&arena) {}
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : m_Arena(other.m_Arena) {}
+
+	T* allocate(size_t count) { return m_Arena->Allocate<T>(count); }
+	void deallocate(T*, size_t) {}
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U>& other) const { return m_Arena == other.m_Arena; }
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const { return m_Arena != other.m_Arena; }
+};
+
+/* a vector that must not outlive the frame it was built in */
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,42 @@
+#include "FrameBuffer.h"
+#include "Renderer.h"
+
+FrameBuffer::FrameBuffer(int width, int height)
+	: m_RendererID(0), m_ColorBuffer(0), m_Width(width), m_Height(height)
+{
+	GlCall(glCreateRenderbuffers(1, &m_ColorBuffer));
+	GlCall(glNamedRenderbufferStorage(m_ColorBuffer, GL_RGBA8, m_Width, m_Height));
+	GlCall(glCreateFramebuffers(1, &m_RendererID));
+	GlCall(glNamedFramebufferRenderbuffer(m_RendererID, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorBuffer));
+}
+
+FrameBuffer::~FrameBuffer()
+{
+	GlCall(glDeleteFramebuffers(1, &m_RendererID));
+	GlCall(glDeleteRenderbuffers(1, &m_ColorBuffer));
+}
+
+void FrameBuffer::Bind() const
+{
+	GlCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GlCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void FrameBuffer::Unbind() const
+{
+	GlCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+bool FrameBuffer::IsComplete() const
+{
+	GlCall(GLenum status = glCheckNamedFramebufferStatus(m_RendererID, GL_FRAMEBUFFER));
+	return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void FrameBuffer::ReadPixels(unsigned char* rgba) const
+{
+	GlCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GlCall(glNamedFramebufferReadBuffer(m_RendererID, GL_COLOR_ATTACHMENT0));
+	GlCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GlCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, rgba));
+}
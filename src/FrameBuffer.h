@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+ * Offscreen render target: an RGBA8 color renderbuffer in its own framebuffer
+ * object.  Used where there is no window to draw into, e.g. benchmark runs.
+ */
+class FrameBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorBuffer;
+	int m_Width;
+	int m_Height;
+public:
+	FrameBuffer(int width, int height);
+	~FrameBuffer();
+
+	/* makes it the draw and read target and sets the viewport to cover it */
+	void Bind() const;
+	void Unbind() const;
+	bool IsComplete() const;
+	/* copies the color buffer into rgba, Width() * Height() * 4 bytes, bottom row first */
+	void ReadPixels(unsigned char* rgba) const;
+
+	int Width() const { return m_Width; }
+	int Height() const { return m_Height; }
+};
@@ -0,0 +1,127 @@
+#include "FramePacer.h"
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+static const char* modeName(PacingMode mode)
+{
+	switch (mode) {
+		case PacingMode::VSync:         return "vsync";
+		case PacingMode::AdaptiveVSync: return "adaptive vsync";
+		case PacingMode::Uncapped:      return "uncapped";
+		case PacingMode::Limited:       return "limited";
+	}
+	return "unknown";
+}
+
+FramePacer::FramePacer(PacingMode mode, double targetRate)
+	: m_Mode(mode), m_TargetRate(targetRate), m_FrameBudget(0), m_SpinThreshold(std::chrono::milliseconds(1))
+{
+	if (m_Mode == PacingMode::Limited && m_TargetRate <= 0.0)
+	{
+		std::cout << "Warning:  frame limit needs a positive rate, running uncapped" << std::endl;
+		m_Mode = PacingMode::Uncapped;
+	}
+
+	if (m_Mode == PacingMode::Limited)
+	{
+		m_FrameBudget = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_TargetRate));
+#ifdef _WIN32
+		/* the default 15.6 ms timer resolution would make every sleep overshoot */
+		timeBeginPeriod(1);
+		m_SpinThreshold = std::chrono::milliseconds(2);
+#endif
+	}
+
+	m_LastFrame = m_Deadline = Clock::now();
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	if (m_Mode == PacingMode::Limited)
+		timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::Apply()
+{
+	switch (m_Mode) {
+		case PacingMode::VSync:
+			glfwSwapInterval(1);  // synchronizes the vsync with the refresh rate of your monitor
+			break;
+		case PacingMode::AdaptiveVSync:
+			if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+				glfwSwapInterval(-1);
+			}
+			else {
+				std::cout << "Warning:  adaptive vsync is not supported, using vsync" << std::endl;
+				m_Mode = PacingMode::VSync;
+				glfwSwapInterval(1);
+			}
+			break;
+		case PacingMode::Uncapped:
+		case PacingMode::Limited:
+			glfwSwapInterval(0);
+			break;
+	}
+
+	std::cout << "Frame pacing: " << modeName(m_Mode);
+	if (m_Mode == PacingMode::Limited)
+		std::cout << " at " << m_TargetRate << " Hz";
+	std::cout << std::endl;
+
+	m_LastFrame = m_Deadline = Clock::now();
+}
+
+void FramePacer::EndFrame()
+{
+	if (m_Mode == PacingMode::Limited)
+	{
+		m_Deadline += m_FrameBudget;
+		Clock::time_point now = Clock::now();
+		if (now > m_Deadline + m_FrameBudget)
+			m_Deadline = now;  // fell a whole frame behind: start over rather than rushing to catch up
+		else
+			WaitUntil(m_Deadline);
+	}
+
+	Clock::time_point now = Clock::now();
+	m_Intervals.Record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - m_LastFrame).count());
+	m_LastFrame = now;
+}
+
+void FramePacer::Resume()
+{
+	m_LastFrame = m_Deadline = Clock::now();
+}
+
+void FramePacer::WaitUntil(Clock::time_point deadline) const
+{
+	Clock::time_point now = Clock::now();
+	if (deadline - now > m_SpinThreshold)
+		std::this_thread::sleep_for(deadline - now - m_SpinThreshold);
+
+	while (Clock::now() < deadline)
+		; // spin the last stretch
+}
+
+void FramePacer::Report() const
+{
+	if (m_Intervals.Count() == 0)
+		return;
+
+	std::cout << "Frame times (" << modeName(m_Mode) << ", " << m_Intervals.Count() << " frames): avg "
+		<< m_Intervals.Mean() / 1000.0 << " ms, min " << m_Intervals.Min() / 1000.0 << " ms, max "
+		<< m_Intervals.Max() / 1000.0 << " ms" << std::endl;
+	std::cout << "  median " << m_Intervals.Percentile(50.0) / 1000.0 << " ms, 95% "
+		<< m_Intervals.Percentile(95.0) / 1000.0 << " ms, 99% " << m_Intervals.Percentile(99.0) / 1000.0 << " ms" << std::endl;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "LatencyHistogram.h"
+
+#include <chrono>
+#include <cstdint>
+
+enum class PacingMode
+{
+	VSync,          // swap interval 1
+	AdaptiveVSync,  // swap interval -1: tears instead of halving the rate when a frame is late
+	Uncapped,       // swap interval 0, no limit; for throughput measurements
+	Limited         // swap interval 0 with a sleep-then-spin limiter at a fixed rate
+};
+
+/*
+ * Sets the swap interval for the chosen pacing mode and, in Limited mode, holds
+ * each frame until its deadline.  The limiter sleeps for most of the remaining
+ * time and spins only for the last stretch, where the OS scheduler is too coarse.
+ * Every frame's achieved duration is recorded for Report().
+ */
+class FramePacer
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	PacingMode m_Mode;
+	double m_TargetRate;
+	Clock::duration m_FrameBudget;
+	Clock::duration m_SpinThreshold;
+	Clock::time_point m_Deadline;
+	Clock::time_point m_LastFrame;
+
+	/* achieved frame intervals over the whole run */
+	LatencyHistogram m_Intervals;
+public:
+	FramePacer(PacingMode mode, double targetRate = 0.0);
+	~FramePacer();
+
+	/* applies the swap interval to the current context; call once it exists */
+	void Apply();
+	/* call right after the buffer swap */
+	void EndFrame();
+	/* call when rendering restarts after the loop sat idle, so the idle time is not counted as a frame */
+	void Resume();
+	void Report() const;
+
+	PacingMode Mode() const { return m_Mode; }
+private:
+	void WaitUntil(Clock::time_point deadline) const;
+};
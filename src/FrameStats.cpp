@@ -0,0 +1,140 @@
+#include "FrameStats.h"
+
+#include <fstream>
+#include <iostream>
+
+static const char* metricName(FrameStats::Metric metric)
+{
+	switch (metric) {
+		case FrameStats::CPU_FRAME:        return "cpu_frame";
+		case FrameStats::SWAP:             return "swap";
+		case FrameStats::INPUT_TO_PRESENT: return "input_to_present";
+		default:                           return "unknown";
+	}
+}
+
+static const double PERCENTILES[] = { 50.0, 90.0, 99.0, 99.9 };
+
+static double toMs(uint64_t us)
+{
+	return us / 1000.0;
+}
+
+FrameStats::FrameStats(double reportSeconds)
+	: m_ReportInterval(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportSeconds))),
+	m_InputPending(false)
+{
+	for (Series& series : m_Series)
+		series.WorstCount = 0;
+	m_NextReport = Clock::now() + m_ReportInterval;
+}
+
+void FrameStats::Record(Metric metric, uint64_t frame, Clock::duration duration)
+{
+	uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	Series& series = m_Series[metric];
+	series.Window.Record(us);
+	series.Total.Record(us);
+
+	/* insertion into a short sorted array; most frames fail the first comparison */
+	int count = series.WorstCount;
+	if (count == WORST_FRAMES && us <= series.Worst[count - 1].Us)
+		return;
+	int i = count < WORST_FRAMES ? count++ : count - 1;
+	for (; i > 0 && series.Worst[i - 1].Us < us; i--)
+		series.Worst[i] = series.Worst[i - 1];
+	series.Worst[i] = { frame, us };
+	series.WorstCount = count;
+}
+
+void FrameStats::InputArrived(Clock::time_point time)
+{
+	if (!m_InputPending)
+	{
+		m_InputPending = true;
+		m_InputTime = time;
+	}
+}
+
+void FrameStats::Presented(uint64_t frame, Clock::time_point now)
+{
+	if (m_InputPending)
+	{
+		m_InputPending = false;
+		Record(INPUT_TO_PRESENT, frame, now - m_InputTime);
+	}
+}
+
+void FrameStats::Update(Clock::time_point now)
+{
+	if (m_ReportInterval <= Clock::duration::zero() || now < m_NextReport)
+		return;
+	m_NextReport = now + m_ReportInterval;
+
+	for (int metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		LatencyHistogram& window = m_Series[metric].Window;
+		if (window.Count())
+			LogSeries("window", (Metric)metric, window);
+		window.Reset();
+	}
+}
+
+void FrameStats::LogSeries(const char* label, Metric metric, const LatencyHistogram& histogram) const
+{
+	std::cout << "Frame stats (" << label << ") " << metricName(metric) << ": " << histogram.Count()
+		<< " samples, mean " << histogram.Mean() / 1000.0 << " ms";
+	for (double percentile : PERCENTILES)
+		std::cout << ", p" << percentile << " " << toMs(histogram.Percentile(percentile)) << " ms";
+	std::cout << ", max " << toMs(histogram.Max()) << " ms" << std::endl;
+}
+
+void FrameStats::Report() const
+{
+	for (int metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		const Series& series = m_Series[metric];
+		if (series.Total.Count() == 0)
+			continue;
+
+		LogSeries("run", (Metric)metric, series.Total);
+		std::cout << "  worst frames:";
+		for (int i = 0; i < series.WorstCount; i++)
+			std::cout << " #" << series.Worst[i].Frame << " " << toMs(series.Worst[i].Us) << " ms";
+		std::cout << std::endl;
+	}
+}
+
+bool FrameStats::WriteJson(const std::string& path) const
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		std::cout << "Warning:  cannot write frame stats to " << path << std::endl;
+		return false;
+	}
+
+	out << "{\n";
+	for (int metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		const Series& series = m_Series[metric];
+		const LatencyHistogram& total = series.Total;
+		out << "  \"" << metricName((Metric)metric) << "\": {\n"
+			<< "    \"count\": " << total.Count() << ",\n"
+			<< "    \"min_ms\": " << toMs(total.Min()) << ",\n"
+			<< "    \"mean_ms\": " << total.Mean() / 1000.0 << ",\n"
+			<< "    \"max_ms\": " << toMs(total.Max()) << ",\n"
+			<< "    \"p50_ms\": " << toMs(total.Percentile(50.0)) << ",\n"
+			<< "    \"p90_ms\": " << toMs(total.Percentile(90.0)) << ",\n"
+			<< "    \"p99_ms\": " << toMs(total.Percentile(99.0)) << ",\n"
+			<< "    \"p99_9_ms\": " << toMs(total.Percentile(99.9)) << ",\n"
+			<< "    \"worst_frames\": [";
+		for (int i = 0; i < series.WorstCount; i++)
+			out << (i ? ", " : "") << "{ \"frame\": " << series.Worst[i].Frame << ", \"ms\": " << toMs(series.Worst[i].Us) << " }";
+		out << "]\n  }" << (metric + 1 < METRIC_COUNT ? "," : "") << "\n";
+	}
+	out << "}\n";
+
+	std::cout << "Frame stats written to " << path << std::endl;
+	return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "LatencyHistogram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*
+ * Per-frame latency distributions for the frame loop: CPU time spent building a
+ * frame, time blocked in the buffer swap, and the delay from the first input
+ * event of a frame to the swap that shows its result.  Each metric keeps a
+ * histogram over the current reporting window and one over the whole run, plus
+ * the worst frames seen; none of it allocates while recording.
+ */
+class FrameStats
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	enum Metric
+	{
+		CPU_FRAME,
+		SWAP,
+		INPUT_TO_PRESENT,
+		METRIC_COUNT
+	};
+
+	struct WorstFrame
+	{
+		uint64_t Frame;
+		uint64_t Us;
+	};
+	static const int WORST_FRAMES = 8;
+private:
+	struct Series
+	{
+		LatencyHistogram Window;
+		LatencyHistogram Total;
+		WorstFrame Worst[WORST_FRAMES];  // slowest first
+		int WorstCount;
+	};
+
+	Series m_Series[METRIC_COUNT];
+	Clock::duration m_ReportInterval;
+	Clock::time_point m_NextReport;
+	Clock::time_point m_InputTime;
+	bool m_InputPending;
+public:
+	/* reportSeconds <= 0 only reports at exit */
+	FrameStats(double reportSeconds);
+
+	void Record(Metric metric, uint64_t frame, Clock::duration duration);
+	/* time is when an input callback saw the event; the first event since the last present starts the clock */
+	void InputArrived(Clock::time_point time);
+	/* call right after the swap */
+	void Presented(uint64_t frame, Clock::time_point now);
+	/* logs and restarts the window histograms once the reporting interval has passed */
+	void Update(Clock::time_point now);
+
+	void Report() const;
+	bool WriteJson(const std::string& path) const;
+
+	const LatencyHistogram& Total(Metric metric) const { return m_Series[metric].Total; }
+private:
+	void LogSeries(const char* label, Metric metric, const LatencyHistogram& histogram) const;
+};
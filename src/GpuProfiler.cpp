@@ -0,0 +1,132 @@
+#include "GpuProfiler.h"
+#include "Renderer.h"
+
+#include <cstring>
+#include <iostream>
+
+GpuProfiler::GpuProfiler()
+	: m_StatsCount(0), m_FrameIndex(0), m_DroppedFrames(0), m_LastFrameMs(0.0)
+{
+	for (Frame& frame : m_Frames)
+	{
+		GlCall(glCreateQueries(GL_TIMESTAMP, MAX_SCOPES * 2, frame.Queries));
+		frame.ScopeCount = 0;
+		frame.Pending = false;
+	}
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (Frame& frame : m_Frames) {
+		GlCall(glDeleteQueries(MAX_SCOPES * 2, frame.Queries));
+	}
+}
+
+void GpuProfiler::BeginFrame()
+{
+	Frame& frame = m_Frames[m_FrameIndex % FRAMES_IN_FLIGHT];
+	if (frame.Pending)
+		Collect(frame);
+
+	frame.ScopeCount = 0;
+	frame.Pending = false;
+	m_FrameIndex++;
+}
+
+int GpuProfiler::Begin(const char* name)
+{
+	if (m_FrameIndex == 0)
+		return -1;  // no frame begun yet
+
+	Frame& frame = m_Frames[(m_FrameIndex - 1) % FRAMES_IN_FLIGHT];
+	if (frame.ScopeCount == MAX_SCOPES)
+		return -1;
+
+	int stats = FindStats(name);
+	if (stats < 0)
+		return -1;
+
+	int scope = frame.ScopeCount++;
+	frame.Stats[scope] = stats;
+	frame.LastQuery = frame.Queries[scope * 2];
+	frame.Pending = true;
+	GlCall(glQueryCounter(frame.LastQuery, GL_TIMESTAMP));
+	return scope;
+}
+
+void GpuProfiler::End(int scope)
+{
+	if (scope < 0)
+		return;
+
+	Frame& frame = m_Frames[(m_FrameIndex - 1) % FRAMES_IN_FLIGHT];
+	frame.LastQuery = frame.Queries[scope * 2 + 1];
+	GlCall(glQueryCounter(frame.LastQuery, GL_TIMESTAMP));
+}
+
+const GpuProfiler::ScopeStats* GpuProfiler::GetStats(const char* name) const
+{
+	for (int i = 0; i < m_StatsCount; i++)
+		if (m_Stats[i].Name == name || strcmp(m_Stats[i].Name, name) == 0)
+			return &m_Stats[i];
+	return nullptr;
+}
+
+void GpuProfiler::Report() const
+{
+	std::cout << "GPU scopes (" << m_FrameIndex << " frames, " << m_DroppedFrames << " dropped):" << std::endl;
+	for (int i = 0; i < m_StatsCount; i++)
+	{
+		const ScopeStats& stats = m_Stats[i];
+		if (stats.Count == 0)
+			continue;
+		std::cout << "  " << stats.Name << ": min " << stats.MinMs << " ms, avg " << stats.TotalMs / stats.Count
+			<< " ms, max " << stats.MaxMs << " ms" << std::endl;
+	}
+}
+
+int GpuProfiler::FindStats(const char* name)
+{
+	/* names are literals, so the pointer usually matches before strcmp is needed */
+	for (int i = 0; i < m_StatsCount; i++)
+		if (m_Stats[i].Name == name || strcmp(m_Stats[i].Name, name) == 0)
+			return i;
+
+	if (m_StatsCount == MAX_NAMES)
+		return -1;
+
+	ScopeStats& stats = m_Stats[m_StatsCount];
+	stats.Name = name;
+	stats.LastMs = stats.MinMs = stats.MaxMs = stats.TotalMs = 0.0;
+	stats.Count = 0;
+	return m_StatsCount++;
+}
+
+void GpuProfiler::Collect(Frame& frame)
+{
+	/* queries complete in order, so the last one being ready means all of them are */
+	int available = 0;
+	GlCall(glGetQueryObjectiv(frame.LastQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+	{
+		m_DroppedFrames++;
+		return;
+	}
+
+	m_LastFrameMs = 0.0;
+	for (int i = 0; i < frame.ScopeCount; i++)
+	{
+		GLuint64 begin, end;
+		GlCall(glGetQueryObjectui64v(frame.Queries[i * 2], GL_QUERY_RESULT, &begin));
+		GlCall(glGetQueryObjectui64v(frame.Queries[i * 2 + 1], GL_QUERY_RESULT, &end));
+
+		double ms = (end - begin) / 1000000.0;
+		ScopeStats& stats = m_Stats[frame.Stats[i]];
+		stats.LastMs = ms;
+		m_LastFrameMs += ms;
+		stats.MinMs = stats.Count == 0 ? ms : (ms < stats.MinMs ? ms : stats.MinMs);
+		stats.MaxMs = ms > stats.MaxMs ? ms : stats.MaxMs;
+		stats.TotalMs += ms;
+		stats.Count++;
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+/*
+ * GPU timing with timestamp queries (glQueryCounter), which unlike
+ * GL_TIME_ELAPSED may nest.  Queries of a frame are read back FRAMES_IN_FLIGHT
+ * frames later, only if the GPU has finished them, so reading never stalls the
+ * pipeline; a frame whose results are still not ready is dropped instead.
+ *
+ * Scopes are named with string literals and accumulate min/avg/max per name.
+ */
+class GpuProfiler
+{
+public:
+	static const int FRAMES_IN_FLIGHT = 4;
+	static const int MAX_SCOPES = 32;      // per frame
+	static const int MAX_NAMES = 32;       // distinct scope names
+
+	struct ScopeStats
+	{
+		const char* Name;
+		double LastMs;
+		double MinMs;
+		double MaxMs;
+		double TotalMs;
+		uint64_t Count;
+	};
+private:
+	struct Frame
+	{
+		unsigned int Queries[MAX_SCOPES * 2];  // begin and end timestamp per scope
+		int Stats[MAX_SCOPES];                 // scope -> index into m_Stats
+		int ScopeCount;
+		unsigned int LastQuery;                // the most recently issued query of the frame
+		bool Pending;
+	};
+
+	Frame m_Frames[FRAMES_IN_FLIGHT];
+	ScopeStats m_Stats[MAX_NAMES];
+	int m_StatsCount;
+	uint64_t m_FrameIndex;
+	uint64_t m_DroppedFrames;
+	double m_LastFrameMs;                  // sum of the scopes of the last collected frame
+public:
+	GpuProfiler();
+	~GpuProfiler();
+
+	/* collects the results of the frame that used this slot FRAMES_IN_FLIGHT frames ago */
+	void BeginFrame();
+	/* returns the scope to pass to End(), or -1 before the first BeginFrame() or when the frame is out of scopes */
+	int Begin(const char* name);
+	void End(int scope);
+
+	const ScopeStats* GetStats(const char* name) const;
+	double LastFrameMs() const { return m_LastFrameMs; }
+	void Report() const;
+private:
+	int FindStats(const char* name);
+	void Collect(Frame& frame);
+};
+
+/* times the rest of the enclosing block on the GPU */
+class GpuScope
+{
+private:
+	GpuProfiler& m_Profiler;
+	int m_Scope;
+public:
+	GpuScope(GpuProfiler& profiler, const char* name) : m_Profiler(profiler), m_Scope(profiler.Begin(name)) {}
+	~GpuScope() { m_Profiler.End(m_Scope); }
+};
+
+#define GPU_SCOPE_CONCAT2(a, b) a##b
+#define GPU_SCOPE_CONCAT(a, b) GPU_SCOPE_CONCAT2(a, b)
+#define GPU_SCOPE(profiler, name) GpuScope GPU_SCOPE_CONCAT(gpuScope, __LINE__)(profiler, name)
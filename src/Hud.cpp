@@ -0,0 +1,248 @@
+#include "Hud.h"
+#include "Shader.h"
+
+#include <cstddef>
+#include <cstdio>
+
+/* font8x8_basic by Daniel Hepper (public domain), U+0020 to U+007E; bit 0 is the leftmost pixel */
+static const unsigned char FONT8X8[95][8] =
+{
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0020 (space)
+	{ 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 }, // U+0021 (!)
+	{ 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0022 (")
+	{ 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 }, // U+0023 (#)
+	{ 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 }, // U+0024 ($)
+	{ 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 }, // U+0025 (%)
+	{ 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 }, // U+0026 (&)
+	{ 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0027 (')
+	{ 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 }, // U+0028 (()
+	{ 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 }, // U+0029 ())
+	{ 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 }, // U+002A (*)
+	{ 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 }, // U+002B (+)
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // U+002C (,)
+	{ 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 }, // U+002D (-)
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // U+002E (.)
+	{ 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 }, // U+002F (/)
+	{ 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 }, // U+0030 (0)
+	{ 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 }, // U+0031 (1)
+	{ 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 }, // U+0032 (2)
+	{ 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 }, // U+0033 (3)
+	{ 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 }, // U+0034 (4)
+	{ 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 }, // U+0035 (5)
+	{ 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 }, // U+0036 (6)
+	{ 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 }, // U+0037 (7)
+	{ 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 }, // U+0038 (8)
+	{ 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 }, // U+0039 (9)
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 }, // U+003A (:)
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 }, // U+003B (;)
+	{ 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 }, // U+003C (<)
+	{ 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 }, // U+003D (=)
+	{ 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 }, // U+003E (>)
+	{ 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 }, // U+003F (?)
+	{ 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 }, // U+0040 (@)
+	{ 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 }, // U+0041 (A)
+	{ 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 }, // U+0042 (B)
+	{ 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 }, // U+0043 (C)
+	{ 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 }, // U+0044 (D)
+	{ 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 }, // U+0045 (E)
+	{ 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 }, // U+0046 (F)
+	{ 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 }, // U+0047 (G)
+	{ 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 }, // U+0048 (H)
+	{ 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // U+0049 (I)
+	{ 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 }, // U+004A (J)
+	{ 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 }, // U+004B (K)
+	{ 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 }, // U+004C (L)
+	{ 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 }, // U+004D (M)
+	{ 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 }, // U+004E (N)
+	{ 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 }, // U+004F (O)
+	{ 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 }, // U+0050 (P)
+	{ 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 }, // U+0051 (Q)
+	{ 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 }, // U+0052 (R)
+	{ 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 }, // U+0053 (S)
+	{ 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // U+0054 (T)
+	{ 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 }, // U+0055 (U)
+	{ 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // U+0056 (V)
+	{ 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 }, // U+0057 (W)
+	{ 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 }, // U+0058 (X)
+	{ 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 }, // U+0059 (Y)
+	{ 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 }, // U+005A (Z)
+	{ 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 }, // U+005B ([)
+	{ 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 }, // U+005C (\)
+	{ 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 }, // U+005D (])
+	{ 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 }, // U+005E (^)
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }, // U+005F (_)
+	{ 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0060 (`)
+	{ 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 }, // U+0061 (a)
+	{ 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 }, // U+0062 (b)
+	{ 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 }, // U+0063 (c)
+	{ 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 }, // U+0064 (d)
+	{ 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 }, // U+0065 (e)
+	{ 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 }, // U+0066 (f)
+	{ 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // U+0067 (g)
+	{ 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 }, // U+0068 (h)
+	{ 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // U+0069 (i)
+	{ 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E }, // U+006A (j)
+	{ 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 }, // U+006B (k)
+	{ 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 }, // U+006C (l)
+	{ 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 }, // U+006D (m)
+	{ 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 }, // U+006E (n)
+	{ 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 }, // U+006F (o)
+	{ 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F }, // U+0070 (p)
+	{ 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 }, // U+0071 (q)
+	{ 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 }, // U+0072 (r)
+	{ 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 }, // U+0073 (s)
+	{ 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 }, // U+0074 (t)
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 }, // U+0075 (u)
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 }, // U+0076 (v)
+	{ 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 }, // U+0077 (w)
+	{ 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 }, // U+0078 (x)
+	{ 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F }, // U+0079 (y)
+	{ 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 }, // U+007A (z)
+	{ 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 }, // U+007B ({)
+	{ 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // U+007C (|)
+	{ 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 }, // U+007D (})
+	{ 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+007E (~)
+};
+
+static const int ATLAS_COLUMNS = 16;
+static const int ATLAS_WIDTH = ATLAS_COLUMNS * 8;
+static const int ATLAS_HEIGHT = 8 * 8;
+static const unsigned int SOLID_GLYPH = 127;  // DEL has no glyph of its own; it is a filled cell
+
+static const float SCALE = 2.0f;             // screen pixels per font pixel
+static const float MARGIN = 6.0f;
+static const float LINE_HEIGHT = 10.0f * SCALE;
+static const float GRAPH_HEIGHT = 64.0f;
+static const float GRAPH_MAX_MS = 33.3f;     // two 60 Hz frames fill the graph
+static const float BAR_WIDTH = 2.0f;
+
+static unsigned int rgba(unsigned int r, unsigned int g, unsigned int b, unsigned int a)
+{
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+Hud::Hud(Shader& shader)
+	: m_Shader(shader), m_VertexArray(0), m_InstanceBuffer(0), m_Atlas(0), m_QuadCount(0), m_GraphHead(0), m_Visible(true)
+{
+	m_ScreenUniform = m_Shader.GetUniform("u_Screen", GL_FLOAT_VEC4);
+	for (float& sample : m_Graph)
+		sample = 0.0f;
+
+	/* expand the bitmap font into an R8 atlas, 16 glyphs per row indexed by character code */
+	unsigned char pixels[ATLAS_WIDTH * ATLAS_HEIGHT] = {};
+	for (unsigned int glyph = 0x20; glyph <= SOLID_GLYPH; glyph++)
+	{
+		int cellX = (glyph % ATLAS_COLUMNS) * 8;
+		int cellY = (glyph / ATLAS_COLUMNS) * 8;
+		for (int y = 0; y < 8; y++)
+		{
+			unsigned char bits = glyph == SOLID_GLYPH ? 0xFF : FONT8X8[glyph - 0x20][y];
+			for (int x = 0; x < 8; x++)
+				pixels[(cellY + y) * ATLAS_WIDTH + cellX + x] = (bits >> x) & 1 ? 0xFF : 0x00;
+		}
+	}
+	GlCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_Atlas));
+	GlCall(glTextureStorage2D(m_Atlas, 1, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT));
+	GlCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GlCall(glTextureSubImage2D(m_Atlas, 0, 0, 0, ATLAS_WIDTH, ATLAS_HEIGHT, GL_RED, GL_UNSIGNED_BYTE, pixels));
+
+	GlCall(glCreateBuffers(1, &m_InstanceBuffer));
+	GlCall(glNamedBufferStorage(m_InstanceBuffer, sizeof(m_Quads), nullptr, GL_DYNAMIC_STORAGE_BIT));
+
+	GlCall(glCreateVertexArrays(1, &m_VertexArray));
+	GlCall(glVertexArrayVertexBuffer(m_VertexArray, 0, m_InstanceBuffer, 0, sizeof(Quad)));
+	GlCall(glVertexArrayBindingDivisor(m_VertexArray, 0, 1));
+	GlCall(glEnableVertexArrayAttrib(m_VertexArray, 0));
+	GlCall(glVertexArrayAttribFormat(m_VertexArray, 0, 4, GL_FLOAT, GL_FALSE, offsetof(Quad, X)));
+	GlCall(glVertexArrayAttribBinding(m_VertexArray, 0, 0));
+	GlCall(glEnableVertexArrayAttrib(m_VertexArray, 1));
+	GlCall(glVertexArrayAttribIFormat(m_VertexArray, 1, 1, GL_UNSIGNED_INT, offsetof(Quad, Glyph)));
+	GlCall(glVertexArrayAttribBinding(m_VertexArray, 1, 0));
+	GlCall(glEnableVertexArrayAttrib(m_VertexArray, 2));
+	GlCall(glVertexArrayAttribFormat(m_VertexArray, 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Quad, Color)));
+	GlCall(glVertexArrayAttribBinding(m_VertexArray, 2, 0));
+}
+
+Hud::~Hud()
+{
+	GlCall(glDeleteVertexArrays(1, &m_VertexArray));
+	GlCall(glDeleteBuffers(1, &m_InstanceBuffer));
+	GlCall(glDeleteTextures(1, &m_Atlas));
+}
+
+void Hud::AddQuad(float x, float y, float width, float height, unsigned int glyph, unsigned int color)
+{
+	if (m_QuadCount == MAX_QUADS)
+		return;
+	m_Quads[m_QuadCount++] = { x, y, width, height, glyph, color };
+}
+
+void Hud::AddText(float x, float y, const char* text, unsigned int color)
+{
+	for (; *text; text++, x += 8.0f * SCALE)
+	{
+		unsigned char c = (unsigned char)*text;
+		if (c > 0x20 && c < SOLID_GLYPH)
+			AddQuad(x, y, 8.0f * SCALE, 8.0f * SCALE, c, color);
+	}
+}
+
+void Hud::Update(const FrameInfo& info)
+{
+	m_Graph[m_GraphHead] = (float)info.FrameMs;
+	m_GraphHead = (m_GraphHead + 1) % GRAPH_SAMPLES;
+
+	m_QuadCount = 0;
+	if (!m_Visible)
+		return;
+
+	char text[4][64];
+	snprintf(text[0], sizeof(text[0]), "frame %6.2f ms %5.0f fps", info.FrameMs, info.FrameMs > 0.0 ? 1000.0 / info.FrameMs : 0.0);
+	snprintf(text[1], sizeof(text[1]), "cpu   %6.2f ms  gpu %5.2f ms", info.CpuMs, info.GpuMs);
+	snprintf(text[2], sizeof(text[2]), "draws %u  verts %llu", info.Stats.DrawCalls, info.Stats.Vertices);
+	snprintf(text[3], sizeof(text[3]), "uploads %u  %llu bytes", info.Stats.Uploads, info.Stats.UploadBytes);
+
+	float graphTop = MARGIN * 3 + 4 * LINE_HEIGHT;
+	float panelWidth = 29 * 8.0f * SCALE + MARGIN * 2;
+	AddQuad(MARGIN, MARGIN, panelWidth, graphTop + GRAPH_HEIGHT, SOLID_GLYPH, rgba(0, 0, 0, 160));
+
+	for (int i = 0; i < 4; i++)
+		AddText(MARGIN * 2, MARGIN * 2 + i * LINE_HEIGHT, text[i], rgba(255, 255, 255, 255));
+
+	/* frame time bars, oldest on the left; green within a 60 Hz frame, yellow within two, red beyond */
+	float graphBottom = graphTop + GRAPH_HEIGHT;
+	for (int i = 0; i < GRAPH_SAMPLES; i++)
+	{
+		float ms = m_Graph[(m_GraphHead + i) % GRAPH_SAMPLES];
+		float height = (ms < GRAPH_MAX_MS ? ms : GRAPH_MAX_MS) / GRAPH_MAX_MS * GRAPH_HEIGHT;
+		unsigned int color = ms <= 16.7f ? rgba(64, 220, 64, 255) : ms <= GRAPH_MAX_MS ? rgba(230, 200, 40, 255) : rgba(230, 50, 50, 255);
+		AddQuad(MARGIN * 2 + i * BAR_WIDTH, graphBottom - height, BAR_WIDTH, height, SOLID_GLYPH, color);
+	}
+	AddQuad(MARGIN * 2, graphBottom - 16.7f / GRAPH_MAX_MS * GRAPH_HEIGHT, GRAPH_SAMPLES * BAR_WIDTH, 1.0f, SOLID_GLYPH, rgba(255, 255, 255, 128));
+}
+
+void Hud::Draw(int width, int height)
+{
+	if (!m_Visible || m_QuadCount == 0 || width <= 0 || height <= 0)
+		return;
+
+	int program = 0, vertexArray = 0;
+	GlCall(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+	GlCall(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray));
+
+	GlCall(glNamedBufferSubData(m_InstanceBuffer, 0, m_QuadCount * sizeof(Quad), m_Quads));
+	CountUpload(m_QuadCount * sizeof(Quad));
+	m_Shader.SetUniform4f(m_ScreenUniform, (float)width, (float)height, 0.0f, 0.0f);
+
+	m_Shader.Bind();
+	GlCall(glBindVertexArray(m_VertexArray));
+	GlCall(glBindTextureUnit(0, m_Atlas));
+	GlCall(glEnable(GL_BLEND));
+	GlCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	GlCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_QuadCount));
+	CountDraw(4ull * m_QuadCount);
+	GlCall(glDisable(GL_BLEND));
+
+	GlCall(glBindVertexArray(vertexArray));
+	GlCall(glUseProgram(program));
+}
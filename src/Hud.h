@@ -0,0 +1,57 @@
+#pragma once
+#include "Renderer.h"
+
+class Shader;
+
+/*
+ * Performance overlay: frame time graph, draw calls, vertices, uploads and GPU
+ * time in the top left corner.  Text and graph bars are all quads from one 8x8
+ * glyph atlas (bars use a solid glyph), uploaded together and drawn with a single
+ * instanced draw.
+ */
+class Hud
+{
+public:
+	static const int MAX_QUADS = 1024;
+	static const int GRAPH_SAMPLES = 120;
+
+	struct FrameInfo
+	{
+		double FrameMs;      // time since the previous frame
+		double CpuMs;        // CPU time of the previous frame, up to the swap
+		double GpuMs;        // GPU time of the most recent frame the profiler collected
+		RenderStats Stats;   // counters of the previous frame
+	};
+private:
+	struct Quad
+	{
+		float X, Y, Width, Height;
+		unsigned int Glyph;
+		unsigned int Color;  // RGBA8
+	};
+
+	Shader& m_Shader;
+	int m_ScreenUniform;
+	unsigned int m_VertexArray;
+	unsigned int m_InstanceBuffer;
+	unsigned int m_Atlas;
+	Quad m_Quads[MAX_QUADS];
+	int m_QuadCount;
+	float m_Graph[GRAPH_SAMPLES];  // frame times, oldest at m_GraphHead
+	int m_GraphHead;
+	bool m_Visible;
+public:
+	Hud(Shader& shader);
+	~Hud();
+
+	void Toggle() { m_Visible = !m_Visible; }
+	bool Visible() const { return m_Visible; }
+
+	/* call once per frame; the graph keeps recording while the overlay is hidden */
+	void Update(const FrameInfo& info);
+	/* restores the program and vertex array it replaces */
+	void Draw(int width, int height);
+private:
+	void AddQuad(float x, float y, float width, float height, unsigned int glyph, unsigned int color);
+	void AddText(float x, float y, const char* text, unsigned int color);
+};
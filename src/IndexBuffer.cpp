@@ -1,14 +1,22 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	: m_Count(count)
 {
+	PROFILE_FUNCTION();
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
 	GlCall(glGenBuffers(1, &m_RendererID));
 	GlCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
 	GlCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	CountUpload(count * sizeof(unsigned int));
+}
+
+void IndexBuffer::Bind() const
+{
+	GlCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
 }
 
 IndexBuffer::~IndexBuffer()
@@ -8,6 +8,8 @@ private:
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
+	void Bind() const;
 
 	inline unsigned int GetCount() const { return m_Count;  }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
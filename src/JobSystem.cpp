@@ -0,0 +1,210 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Renderer.h"
+
+namespace {
+	/* the system the current thread works for, and its worker index in it */
+	thread_local const JobSystem* currentSystem = nullptr;
+	thread_local unsigned int currentWorker = 0;
+
+	const int SPIN_ROUNDS = 64;   // failed searches before an idle worker sleeps
+}
+
+JobSystem::JobSystem(unsigned int workers)
+	: m_Running(true), m_Queued(0), m_Sleeping(0)
+{
+	if (workers == 0)
+		workers = std::thread::hardware_concurrency();
+	if (workers == 0)
+		workers = 1;
+
+	for (unsigned int i = 0; i < workers; i++) {
+		std::unique_ptr<Worker> worker(new Worker());
+		worker->Head = 0;
+		worker->Tail = 0;
+		worker->Pool.reset(new Job[MAX_JOBS]);
+		for (unsigned int j = 0; j < MAX_JOBS; j++)
+			worker->Pool[j].Unfinished.store(0, std::memory_order_relaxed);
+		worker->Allocated = 0;
+		worker->StealSeed = 0x9E3779B9u * (i + 1);
+		m_Workers.push_back(std::move(worker));
+	}
+
+	ASSERT(currentSystem == nullptr);
+	currentSystem = this;
+	currentWorker = 0;
+	for (unsigned int i = 1; i < workers; i++)
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Running.store(false);
+	}
+	m_Wake.notify_all();
+	for (std::thread& thread : m_Threads)
+		thread.join();
+	currentSystem = nullptr;
+}
+
+unsigned int JobSystem::WorkerIndex() const
+{
+	ASSERT(currentSystem == this);
+	return currentWorker;
+}
+
+JobSystem::Job* JobSystem::Allocate(Job* parent)
+{
+	/* the next free job of the ring; a long-running one (an outer parallel-for root, say) is skipped */
+	Worker& worker = *m_Workers[WorkerIndex()];
+	Job* job = &worker.Pool[worker.Allocated++ & (MAX_JOBS - 1)];
+	for (unsigned int tries = 1; job->Unfinished.load(std::memory_order_acquire) != 0; tries++) {
+		ASSERT(tries < MAX_JOBS);  // every job of the ring is in flight
+		job = &worker.Pool[worker.Allocated++ & (MAX_JOBS - 1)];
+	}
+
+	job->Parent = parent;
+	job->Unfinished.store(1, std::memory_order_relaxed);
+	job->Pending.store(1, std::memory_order_relaxed);
+	job->ContinuationCount = 0;
+	if (parent)
+		parent->Unfinished.fetch_add(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::AddDependency(Job* job, Job* dependency)
+{
+	ASSERT(dependency->ContinuationCount < MAX_CONTINUATIONS);
+	dependency->Continuations[dependency->ContinuationCount++] = job;
+	job->Pending.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::Run(Job* job)
+{
+	if (job->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		Push(WorkerIndex(), job);
+}
+
+void JobSystem::Push(unsigned int index, Job* job)
+{
+	Worker& worker = *m_Workers[index];
+	{
+		std::lock_guard<std::mutex> lock(worker.QueueMutex);
+		ASSERT(worker.Tail - worker.Head < MAX_JOBS);
+		worker.Queue[worker.Tail++ & (MAX_JOBS - 1)] = job;
+	}
+	m_Queued.fetch_add(1);
+
+	/* a sleeper either sees the new count before it waits or is woken here */
+	if (m_Sleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Wake.notify_one();
+	}
+}
+
+JobSystem::Job* JobSystem::Pop(unsigned int index)
+{
+	Worker& worker = *m_Workers[index];
+	std::lock_guard<std::mutex> lock(worker.QueueMutex);
+	if (worker.Tail == worker.Head)
+		return nullptr;
+	m_Queued.fetch_sub(1, std::memory_order_relaxed);
+	return worker.Queue[--worker.Tail & (MAX_JOBS - 1)];
+}
+
+JobSystem::Job* JobSystem::Steal(unsigned int thief)
+{
+	unsigned int count = (unsigned int)m_Workers.size();
+	if (count < 2)
+		return nullptr;
+
+	/* start at a random victim, so thieves spread over the queues */
+	uint32_t& seed = m_Workers[thief]->StealSeed;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	unsigned int start = seed % count;
+	for (unsigned int i = 0; i < count; i++) {
+		unsigned int index = (start + i) % count;
+		if (index == thief)
+			continue;
+		Worker& victim = *m_Workers[index];
+		std::lock_guard<std::mutex> lock(victim.QueueMutex);
+		if (victim.Tail != victim.Head) {
+			m_Queued.fetch_sub(1, std::memory_order_relaxed);
+			return victim.Queue[victim.Head++ & (MAX_JOBS - 1)];
+		}
+	}
+	return nullptr;
+}
+
+JobSystem::Job* JobSystem::GetJob(unsigned int index)
+{
+	if (Job* job = Pop(index))
+		return job;
+	return Steal(index);
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->Function(job->Data);
+	Finish(job, WorkerIndex());
+}
+
+void JobSystem::Finish(Job* job, unsigned int worker)
+{
+	/* read the links first: once the count reaches zero the job may be recycled */
+	Job* parent = job->Parent;
+	int continuations = job->ContinuationCount;
+	Job* ready[MAX_CONTINUATIONS];
+	for (int i = 0; i < continuations; i++)
+		ready[i] = job->Continuations[i];
+	if (job->Unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	for (int i = 0; i < continuations; i++)
+		if (ready[i]->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			Push(worker, ready[i]);
+	if (parent)
+		Finish(parent, worker);
+}
+
+void JobSystem::Wait(Job* job)
+{
+	unsigned int index = WorkerIndex();
+	while (!IsFinished(job)) {
+		if (Job* next = GetJob(index))
+			Execute(next);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	currentSystem = this;
+	currentWorker = index;
+	Profiler::SetThreadName("job worker");
+
+	int idleRounds = 0;
+	while (m_Running.load(std::memory_order_relaxed)) {
+		if (Job* job = GetJob(index)) {
+			PROFILE_SCOPE("job");
+			Execute(job);
+			idleRounds = 0;
+			continue;
+		}
+		if (++idleRounds < SPIN_ROUNDS) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping.fetch_add(1);
+		m_Wake.wait(lock, [this] { return m_Queued.load() > 0 || !m_Running.load(); });
+		m_Sleeping.fetch_sub(1);
+		idleRounds = 0;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Work-stealing job system.  Every worker thread, and the thread that created
+ * the system (worker 0), owns a queue: it pushes and pops its own jobs at the
+ * back, while idle workers steal from the front of other queues.  Workers with
+ * nothing to do sleep until a job is queued.
+ *
+ * A job is a small callable copied into the job itself, so creating one does
+ * not allocate; each thread recycles the finished jobs of a ring of MAX_JOBS,
+ * which bounds the jobs a thread may have in flight.  Wait only on jobs the
+ * waiting thread created, since a finished job is soon reused.  Jobs can have a parent, which finishes
+ * only after all its children, and dependencies, which hold a job back until
+ * the jobs it depends on have finished.  Wait() runs other jobs while it waits,
+ * so the waiting thread helps instead of blocking.
+ *
+ * Jobs may only be created, run and waited on by the threads of the system.
+ */
+class JobSystem
+{
+public:
+	static const unsigned int MAX_JOBS = 4096;   // per thread, a power of two
+	static const int MAX_CONTINUATIONS = 6;
+	static const int DATA_SIZE = 48;
+
+	struct alignas(64) Job
+	{
+		void (*Function)(void* data);
+		Job* Parent;
+		std::atomic<int> Unfinished;   // the job itself plus its unfinished children
+		std::atomic<int> Pending;      // unfinished dependencies, plus one until Run()
+		int ContinuationCount;
+		Job* Continuations[MAX_CONTINUATIONS];  // jobs that depend on this one
+		alignas(16) unsigned char Data[DATA_SIZE];
+	};
+private:
+	struct alignas(64) Worker
+	{
+		std::mutex QueueMutex;
+		Job* Queue[MAX_JOBS];
+		unsigned int Head;       // stolen from here
+		unsigned int Tail;       // the owner pushes and pops here
+		std::unique_ptr<Job[]> Pool;
+		unsigned int Allocated;
+		uint32_t StealSeed;
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+	std::vector<std::thread> m_Threads;
+	std::atomic<bool> m_Running;
+	std::atomic<int> m_Queued;      // jobs in all queues
+	std::atomic<int> m_Sleeping;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_Wake;
+public:
+	/* workers counts the creating thread; 0 uses every hardware thread */
+	explicit JobSystem(unsigned int workers = 0);
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	unsigned int Workers() const { return (unsigned int)m_Workers.size(); }
+
+	/* the callable is copied into the job; it must be trivially copyable and fit in DATA_SIZE bytes */
+	template<typename F>
+	Job* Create(const F& function, Job* parent = nullptr)
+	{
+		static_assert(sizeof(F) <= DATA_SIZE && alignof(F) <= 16, "job data too large; capture by reference or pointer");
+		static_assert(std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value,
+			"job callables are copied bytewise and never destroyed");
+		Job* job = Allocate(parent);
+		job->Function = &Invoke<F>;
+		new (job->Data) F(function);
+		return job;
+	}
+	/* job will not start before dependency has finished; declare it before either of them runs */
+	void AddDependency(Job* job, Job* dependency);
+	/* queues the job, or lets it be queued once its dependencies have finished */
+	void Run(Job* job);
+	/* runs queued jobs until job and its children have finished */
+	void Wait(Job* job);
+	bool IsFinished(const Job* job) const { return job->Unfinished.load(std::memory_order_acquire) == 0; }
+
+	/* calls f(begin, end) over [0, count) in ranges of about grain and returns when all are done */
+	template<typename F>
+	void ParallelFor(unsigned int count, unsigned int grain, const F& f)
+	{
+		if (grain == 0)
+			grain = 1;
+		if (count <= grain || m_Workers.size() == 1) {
+			f(0u, count);
+			return;
+		}
+		/* stay well inside the job ring */
+		const unsigned int maxChunks = MAX_JOBS / 4;
+		if ((count + grain - 1) / grain > maxChunks)
+			grain = (count + maxChunks - 1) / maxChunks;
+
+		Job* root = Create([] {});
+		const F* function = &f;
+		for (unsigned int begin = 0; begin < count; begin += grain) {
+			unsigned int end = count - begin > grain ? begin + grain : count;
+			Run(Create([function, begin, end] { (*function)(begin, end); }, root));
+		}
+		Run(root);
+		Wait(root);
+	}
+private:
+	template<typename F>
+	static void Invoke(void* data) { (*static_cast<F*>(data))(); }
+
+	unsigned int WorkerIndex() const;
+	Job* Allocate(Job* parent);
+	void Push(unsigned int worker, Job* job);
+	Job* Pop(unsigned int worker);
+	Job* Steal(unsigned int thief);
+	Job* GetJob(unsigned int worker);
+	void Execute(Job* job);
+	void Finish(Job* job, unsigned int worker);
+	void WorkerLoop(unsigned int index);
+};
@@ -0,0 +1,51 @@
+#include "LatencyHistogram.h"
+
+#include <cmath>
+#include <cstring>
+
+void LatencyHistogram::Reset()
+{
+	memset(m_Counts, 0, sizeof(m_Counts));
+	m_Count = 0;
+	m_Total = 0;
+	m_Min = UINT64_MAX;
+	m_Max = 0;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	for (int i = 0; i < BUCKETS; i++)
+		m_Counts[i] += other.m_Counts[i];
+	m_Count += other.m_Count;
+	m_Total += other.m_Total;
+	m_Min = other.m_Min < m_Min ? other.m_Min : m_Min;
+	m_Max = other.m_Max > m_Max ? other.m_Max : m_Max;
+}
+
+uint64_t LatencyHistogram::UpperBound(int index)
+{
+	if (index < 2 * SUB_BUCKETS)
+		return (uint64_t)index;
+	int shift = index / SUB_BUCKETS - 1;
+	uint64_t subBucket = (uint64_t)(index - shift * SUB_BUCKETS);
+	return ((subBucket + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const
+{
+	if (m_Count == 0)
+		return 0;
+
+	uint64_t target = (uint64_t)std::ceil(percentile / 100.0 * m_Count);
+	if (target == 0)
+		target = 1;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < BUCKETS; i++)
+	{
+		seen += m_Counts[i];
+		if (seen >= target)
+			return UpperBound(i) < m_Max ? UpperBound(i) : m_Max;
+	}
+	return m_Max;
+}
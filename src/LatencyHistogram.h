@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+ * Fixed-size log-linear histogram of durations in microseconds, in the style of
+ * HdrHistogram: every power of two is split into 64 linear sub-buckets, so a
+ * recorded value is off by at most 1/64 (~1.6%) anywhere between 1 us and two
+ * minutes.  Recording is a bit scan and an increment; nothing is allocated.
+ */
+class LatencyHistogram
+{
+public:
+	static const int SUB_BUCKET_BITS = 6;
+	static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;  // linear steps per power of two
+	static const int MAGNITUDES = 21;                       // the top magnitude covers [2^26, 2^27) us; MAX_VALUE clamps the rest
+	static const int BUCKETS = (MAGNITUDES + 1) * SUB_BUCKETS;
+	static const uint64_t MAX_VALUE = (2ull * SUB_BUCKETS << (MAGNITUDES - 1)) - 1;
+private:
+	uint32_t m_Counts[BUCKETS];
+	uint64_t m_Count;
+	uint64_t m_Total;
+	uint64_t m_Min;
+	uint64_t m_Max;
+public:
+	LatencyHistogram() { Reset(); }
+
+	void Record(uint64_t us)
+	{
+		if (us > MAX_VALUE)
+			us = MAX_VALUE;
+		m_Counts[Index(us)]++;
+		m_Count++;
+		m_Total += us;
+		m_Min = us < m_Min ? us : m_Min;
+		m_Max = us > m_Max ? us : m_Max;
+	}
+	void Reset();
+	/* adds the other histogram's samples, e.g. to combine per-thread histograms */
+	void Merge(const LatencyHistogram& other);
+
+	/* the upper bound of the bucket holding the given percentile (0-100) */
+	uint64_t Percentile(double percentile) const;
+	uint64_t Count() const { return m_Count; }
+	uint64_t Min() const { return m_Count ? m_Min : 0; }
+	uint64_t Max() const { return m_Max; }
+	double Mean() const { return m_Count ? (double)m_Total / m_Count : 0.0; }
+private:
+	static int HighestBit(uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long bit;
+		_BitScanReverse64(&bit, value | 1);
+		return (int)bit;
+#else
+		return 63 - __builtin_clzll(value | 1);
+#endif
+	}
+	/* values below 2 * SUB_BUCKETS map one to one; above that the low bits are dropped */
+	static int Index(uint64_t value)
+	{
+		int shift = HighestBit(value) - SUB_BUCKET_BITS;
+		if (shift < 0)
+			shift = 0;
+		return shift * SUB_BUCKETS + (int)(value >> shift);
+	}
+	static uint64_t UpperBound(int index);
+};
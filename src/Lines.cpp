@@ -10,8 +10,9 @@ Lines::~Lines()
 {
 }
 
-void Lines::Draw()
+void Lines::Draw(unsigned int object)
 {
 	GlCall(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0));
-	GlCall(glDrawElements(mode, m_Vbuffer.Count() / 2, GL_UNSIGNED_INT, nullptr));
+	GlCall(glDrawElementsInstancedBaseInstance(mode, m_Vbuffer.Count() / 2, GL_UNSIGNED_INT, nullptr, 1, object));
+	CountDraw(m_Vbuffer.Count() / 2);
 }
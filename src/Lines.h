@@ -12,5 +12,6 @@ private:
 public:
 	Lines(VertexBuffer& vBuffer, IndexBuffer& iBuffer, int mode);
 	~Lines();
-	void Draw();
+	/* object is the ObjectParams index the shader reads through gl_BaseInstance */
+	void Draw(unsigned int object);
 };
@@ -28,226 +28,334 @@
 	SOFTWARE.
 
 */
+#include "App.h"
 #include "Renderer.h"
-#include "VertexBuffer.h"
-#include "IndexBuffer.h"
-#include "Points.h"
-#include "Lines.h"
-#include "Triangle.h"
-#include "Shader.h"
+#include "Profiler.h"
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <iostream>
-#include <fstream>
+#include <mutex>
 #include <string>
-#include <sstream>
+#include <thread>
+#include <vector>
 
-int modes[] = 
-{
-	GL_POINTS,
-	GL_LINES,
-	GL_LINE_STRIP,
-	GL_LINE_LOOP,
-	GL_TRIANGLES
-};
+const int MAX_PRODUCERS = 8;               // --producers threads; each owns two reserved entities
+const int PRODUCER_INTERVAL_MS = 10;       // how often a producer submits its figure
+const unsigned int STAR_VERTICES = App::PRODUCER_VERTICES;
+const unsigned int EDITOR_BARS = App::EDITOR_BARS;
+const int EDITOR_INTERVAL_MS = 4;          // how often the editor publishes a version
+const int MAX_RENDERERS = 64;              // --renderers
 
-int location = 0;
-int modeIdx = 1;
-int curMode = 0;
-unsigned int vertex_buffer = 0;
-unsigned int idx_buffer = 0;
-Shader* shader;
+static void error_callback(int error, const char* description) {
+	std::cout << "error = " << error << ", description = " << description << std::endl;
+}
 
-/* Normalize lower left screen coordinate system (0 to 3) to center screen coordinate system (-1 to +1)*/
-static float n(float x) 
-{
-	float normal = 2 * (((x - 0) / (3 - 0))) - 1;
-	return normal;
+/*
+ * --producers: a thread outside the renderer that spins a star of lines and
+ * points.  It only ever talks to the render command queue, like any other
+ * thread that wants something drawn.
+ */
+static void producerLoop(App* app, int index, const std::atomic<bool>* running) {
+	Profiler::SetThreadName("producer");
+	const float PI = 3.14159265f;
+	RenderCommandQueue& commands = app->Commands();
+	unsigned int lines = app->ProducerEntity(index);
+	unsigned int points = lines + 1;
+	float centerX = -0.75f + 0.5f * (index % 4);
+	float centerY = index < 4 ? 0.7f : -0.7f;
+
+	RenderCommand command = {};
+	for (int step = 0; running->load(std::memory_order_relaxed); step++) {
+		command.Type = RenderCommand::SET_GEOMETRY;
+		command.VertexCount = STAR_VERTICES;
+		for (unsigned int v = 0; v < STAR_VERTICES; v++) {
+			float angle = step * 0.02f * (index % 2 ? -1.0f : 1.0f) + v * 2.0f * PI / STAR_VERTICES;
+			float radius = v % 2 ? 0.08f : 0.18f;
+			command.Positions[v * 2] = centerX + radius * cosf(angle);
+			command.Positions[v * 2 + 1] = centerY + radius * sinf(angle);
+		}
+		command.Entity = lines;
+		commands.Submit(command);
+		command.Entity = points;
+		commands.Submit(command);
+
+		/* a new hue every second */
+		if (step % (1000 / PRODUCER_INTERVAL_MS) == 0) {
+			float hue = (step / (1000 / PRODUCER_INTERVAL_MS) + index) * 0.7f;
+			command.Type = RenderCommand::SET_COLOR;
+			command.Entity = lines;
+			command.Color = { { 0.5f + 0.5f * cosf(hue), 0.5f + 0.5f * cosf(hue - 2.1f), 0.5f + 0.5f * cosf(hue + 2.1f), 1.0f } };
+			commands.Submit(command);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(PRODUCER_INTERVAL_MS));
+	}
 }
 
-float points[] = 
-{ 
-	n(1.0f), n(1.0f), 
-	n(2.0f), n(1.0f), 
-	n(2.0f), n(2.0f) 
-};
-unsigned int idx3[] = { 0, 1, 2 };
-
-float lines[] = 
-{ 
-	n(0.5f), n(1.0f), 
-	n(2.0f), n(2.0f), 
-	n(1.8f), n(2.6f), 
-	n(0.7f), n(2.2f), 
-	n(1.6f), n(1.2f), 
-	n(1.0f), n(0.5f) 
-};
-unsigned int idx6[] = { 0, 1, 2, 3, 4, 5 };
+/*
+ * --editor: a data thread that edits a row of bars through SceneVersions.  Each
+ * step rewrites the bars of one chunk and publishes a version; the other chunk
+ * is shared with the previous version.  It never waits for the renderer, which
+ * draws whatever version is newest when its frame starts.
+ */
+static void editorLoop(SceneVersions* versions, const std::atomic<bool>* running) {
+	Profiler::SetThreadName("editor");
+	const unsigned int chunks = (EDITOR_BARS + SceneVersions::CHUNK_ENTITIES - 1) / SceneVersions::CHUNK_ENTITIES;
+	for (int step = 0; running->load(std::memory_order_relaxed); step++) {
+		float time = step * EDITOR_INTERVAL_MS * 0.001f;
+		unsigned int first = (step % chunks) * SceneVersions::CHUNK_ENTITIES;
+		unsigned int last = std::min(first + SceneVersions::CHUNK_ENTITIES, EDITOR_BARS);
+		for (unsigned int bar = first; bar < last; bar++) {
+			float x = -0.95f + 1.9f * (bar + 0.5f) / EDITOR_BARS;
+			float height = 0.15f + 0.15f * sinf(3.0f * time + bar * 0.4f);
+			float bar2d[] = { x, -0.45f, x, -0.45f + height };
+			versions->SetGeometry(bar, bar2d, 2);
+			versions->SetColor(bar, { { 0.3f + 2.0f * height, 0.8f - 2.0f * height, 1.0f, 1.0f } });
+		}
+		versions->Publish();
+		std::this_thread::sleep_for(std::chrono::milliseconds(EDITOR_INTERVAL_MS));
+	}
+}
 
-float t1[] = 
-{
-	n(0.3f),   n(1.0f),   n(0.5f),
-	n(2.7f),   n(0.85f),  n(0.0f),
-	n(2.7f),   n(1.15f),  n(0.0f)
-};
-float t2[] = 
-{
-	n(2.53f),  n(0.71f),  n(0.5f),
-	n(1.46f),  n(2.86f),  n(0.0f),
-	n(1.2f),   n(2.71f),  n(0.0f)
-};
-float t3[] = 
+static void usage() {
+	std::cout << "Usage: SimpleDraw [--vsync | --adaptive | --uncapped | --fps <rate>] [--on-demand] [--trace <frames>]" << std::endl;
+	std::cout << "                  [--producers <1-" << MAX_PRODUCERS << ">] [--queue-policy drop | spin | block] [--editor]" << std::endl;
+	std::cout << "       SimpleDraw --benchmark <frames> [--benchmark-out <file>] [--renderers <1-" << MAX_RENDERERS << ">]" << std::endl;
+	std::cout << "       SimpleDraw --alloc-check <frames>" << std::endl;
+	std::cout << "       H toggles the performance overlay" << std::endl;
+	std::cout << "       F12 writes a CPU trace of the next " << App::TRACE_FRAMES << " frames to trace.json" << std::endl;
+}
+
+struct Options
 {
-	n(1.667f), n(2.79f),  n(0.5f),
-	n(0.337f), n(0.786f), n(0.0f),
-	n(0.597f), n(0.636f), n(0.0f)
+	PacingMode Pacing = PacingMode::VSync;
+	double Rate = 0.0;
+	bool OnDemand = false;
+	int TraceFrames = 0;
+	int BenchmarkFrames = 0;
+	std::string BenchmarkOut = "benchmark.json";
+	int AllocCheckFrames = 0;
+	int Producers = 0;
+	QueueFullPolicy QueuePolicy = QueueFullPolicy::Block;
+	bool Editor = false;
+	int Renderers = 1;
 };
 
-static void error_callback(int error, const char* description) {
-	std::cout << "error = " << error << ", description = " << description << std::endl;
+/* Frame pacing from the command line; vsync is the default.  --on-demand only redraws dirty frames.
+   --trace captures the first frames (including startup) as a Chrome trace; not together with --benchmark.
+   --benchmark renders offscreen without a visible window and exits; --renderers runs it on that many
+   renderers at once, each with its own context and thread.
+   --alloc-check runs frames without a visible window and fails if any of them allocates.
+   --producers starts threads that animate figures through the render command queue;
+   --queue-policy picks what they do when it is full.
+   --editor starts a thread that edits bars and publishes them as scene versions. */
+static bool parseArgs(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--on-demand")
+			options.OnDemand = true;
+		else if (arg == "--vsync")
+			options.Pacing = PacingMode::VSync;
+		else if (arg == "--adaptive")
+			options.Pacing = PacingMode::AdaptiveVSync;
+		else if (arg == "--uncapped")
+			options.Pacing = PacingMode::Uncapped;
+		else if (arg == "--fps" && i + 1 < argc) {
+			options.Pacing = PacingMode::Limited;
+			options.Rate = atof(argv[++i]);
+		}
+		else if (arg == "--trace" && i + 1 < argc)
+			options.TraceFrames = atoi(argv[++i]);
+		else if (arg == "--benchmark" && i + 1 < argc)
+			options.BenchmarkFrames = atoi(argv[++i]);
+		else if (arg == "--benchmark-out" && i + 1 < argc)
+			options.BenchmarkOut = argv[++i];
+		else if (arg == "--alloc-check" && i + 1 < argc)
+			options.AllocCheckFrames = atoi(argv[++i]);
+		else if (arg == "--producers" && i + 1 < argc) {
+			options.Producers = atoi(argv[++i]);
+			if (options.Producers < 1 || options.Producers > MAX_PRODUCERS)
+				return false;
+		}
+		else if (arg == "--renderers" && i + 1 < argc) {
+			options.Renderers = atoi(argv[++i]);
+			if (options.Renderers < 1 || options.Renderers > MAX_RENDERERS)
+				return false;
+		}
+		else if (arg == "--editor")
+			options.Editor = true;
+		else if (arg == "--queue-policy" && i + 1 < argc) {
+			if (!RenderCommandQueue::ParsePolicy(argv[++i], options.QueuePolicy))
+				return false;
+		}
+		else
+			return false;
+	}
+	/* benchmark frames never reach Profiler::EndFrame(), so the capture would not end and its zones would skew the numbers */
+	if (options.BenchmarkFrames > 0 && options.TraceFrames > 0)
+		return false;
+	if (options.BenchmarkFrames > 0 || options.AllocCheckFrames > 0) {
+		options.Pacing = PacingMode::Uncapped;
+		options.Producers = 0;
+		options.Editor = false;
+	}
+	return options.Renderers == 1 || options.BenchmarkFrames > 0;
 }
 
-static void drawPoints() {
-	VertexBuffer vBuf(points, 6);
-	IndexBuffer iBuf(idx3, 3);
-	Points points(vBuf, iBuf);
-	points.Draw();
+/* benchmark.json becomes benchmark_2.json for the renderer with index 2 */
+static std::string rendererOutPath(const std::string& path, int index) {
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		dot = path.size();
+	return path.substr(0, dot) + "_" + std::to_string(index) + path.substr(dot);
 }
 
-static void drawLines(int mode) {
-	VertexBuffer vBuf(lines, 12);
-	IndexBuffer iBuf(idx6, 6);
-	Lines lines(vBuf, iBuf, mode);
-	lines.Draw();
+/* Holds the --renderers threads until every one of them is set up, so the clock only times their frames. */
+struct StartGate
+{
+	std::mutex Mutex;
+	std::condition_variable Changed;
+	size_t Arrived = 0;
+	bool Open = false;
+};
+
+static void waitForStart(StartGate& gate) {
+	std::unique_lock<std::mutex> lock(gate.Mutex);
+	gate.Arrived++;
+	gate.Changed.notify_all();
+	gate.Changed.wait(lock, [&] { return gate.Open; });
 }
 
-static void drawTriangles() {
-	VertexBuffer vBuf1(t1, 9);
-	IndexBuffer iBuf(idx3, 3);
-	Triangle t1(vBuf1, iBuf);
-	shader->SetUniform4f("u_Color", 1.0, 0.0, 0.0, 1.0); // red
-	t1.Draw();
-
-	VertexBuffer vBuf2(t2, 9 * sizeof(float));
-	Triangle t2(vBuf2, iBuf);
-	shader->SetUniform4f("u_Color", 0.0, 1.0, 0.0, 1.0); //green
-	t2.Draw();
-
-	VertexBuffer vBuf3(t3, 9 * sizeof(float));
-	Triangle t3(vBuf2, iBuf);
-	shader->SetUniform4f("u_Color", 0.0, 0.0, 1.0, 1.0); // blue
-	t3.Draw();
+/* waits for all `threads`, then lets them go and returns the time they started */
+static std::chrono::steady_clock::time_point openGate(StartGate& gate, size_t threads) {
+	std::unique_lock<std::mutex> lock(gate.Mutex);
+	gate.Changed.wait(lock, [&] { return gate.Arrived == threads; });
+	gate.Open = true;
+	gate.Changed.notify_all();
+	return std::chrono::steady_clock::now();
 }
 
 /*
- * drawScene() handles the animation and the redrawing of the
- *		graphics window contents.
+ * --benchmark with --renderers: one App per thread, each with its own window,
+ * context and scene, all drawing at once.  Reports the combined frame rate of
+ * the time they all spent drawing, without their setup.
  */
-static void drawScene() {
-	switch (curMode) {
-		case GL_POINTS:
-			shader->SetUniform4f("u_Color", 1.0, 0.0, 0.0, 1.0); //red
-			drawPoints();
-			break;
-		case GL_LINES:
-		case GL_LINE_STRIP:
-		case GL_LINE_LOOP:
-			drawLines(curMode);
-			break;
-		case GL_TRIANGLES:
-			drawTriangles();
-			break;
+static int runRenderers(const Options& options, AppConfig config) {
+	/* windows and contexts are made here; GLFW only allows that on the main thread */
+	std::vector<App*> apps;
+	int status = EXIT_SUCCESS;
+	for (int i = 0; i < options.Renderers && status == EXIT_SUCCESS; i++) {
+		config.Name = "renderer " + std::to_string(i);
+		apps.push_back(new App(config));
+		if (!apps.back()->IsValid())
+			status = EXIT_FAILURE;
+	}
+
+	if (status == EXIT_SUCCESS) {
+		std::vector<int> results(apps.size(), EXIT_SUCCESS);
+		std::vector<std::thread> threads;
+		StartGate gate;
+		for (size_t i = 0; i < apps.size(); i++) {
+			threads.emplace_back([&, i] {
+				Profiler::SetThreadName("renderer");
+				bool started = false;
+				results[i] = apps[i]->RunBenchmark(options.BenchmarkFrames, rendererOutPath(options.BenchmarkOut, (int)i),
+					[&] { waitForStart(gate); started = true; });
+				/* a renderer that failed before its first frame still counts as arrived */
+				if (!started)
+					waitForStart(gate);
+			});
+		}
+		auto start = openGate(gate, threads.size());
+		for (std::thread& thread : threads)
+			thread.join();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (int result : results)
+			if (result != EXIT_SUCCESS)
+				status = result;
+		/* every renderer draws each mode's warm-up and measured frames */
+		int warmup = options.BenchmarkFrames / 10 > 0 ? options.BenchmarkFrames / 10 : 1;
+		double frames = (double)apps.size() * App::MODE_COUNT * (options.BenchmarkFrames + warmup);
+		if (status == EXIT_SUCCESS)
+			std::cout << "Renderers: " << apps.size() << " in " << seconds << " s, " << frames / seconds
+				<< " fps combined" << std::endl;
 	}
 
+	for (App* app : apps)
+		delete app;
+	return status;
 }
 
-static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-	if (action != GLFW_PRESS)
-		return;
-
-	switch (key) {
-		case GLFW_KEY_SPACE:
-			modeIdx = modeIdx % A_LENGTH(modes);
-			curMode = modes[modeIdx];
-			modeIdx += 1;
-			break;
-
-		case GLFW_KEY_ESCAPE:
-			std::cout << "Goodbye!" << std::endl;
-			glfwSetWindowShouldClose(window, GL_TRUE);
-			glfwDestroyWindow(window);
-			glfwTerminate();
-			exit(EXIT_SUCCESS);
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseArgs(argc, argv, options)) {
+		usage();
+		exit(EXIT_FAILURE);
 	}
-}
+	Profiler::SetThreadName("main");
+	Profiler::Capture(options.TraceFrames, "trace.json");
 
-int main() {
-	GLFWwindow* window;
+	bool headless = options.BenchmarkFrames > 0 || options.AllocCheckFrames > 0;
+	if (headless && !HasDisplay() && glfwPlatformSupported(GLFW_PLATFORM_NULL))
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
 
 	if (!glfwInit())
 		exit(EXIT_FAILURE);
 
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	//glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
 	glfwSetErrorCallback(error_callback);
 
-	window = glfwCreateWindow(640, 480, "SimpleDraw", NULL, NULL);
-	if (!window) {
+	AppConfig config;
+	config.Visible = !headless;
+	config.Pacing = options.Pacing;
+	config.Rate = options.Rate;
+	config.OnDemand = options.OnDemand;
+	config.Producers = options.Producers;
+	config.QueuePolicy = options.QueuePolicy;
+	config.Editor = options.Editor;
+
+	if (options.Renderers > 1) {
+		int status = runRenderers(options, config);
 		glfwTerminate();
-		exit(EXIT_FAILURE);
+		return status;
 	}
 
-	glfwMakeContextCurrent(window);
-
-	glfwSwapInterval(1);  // synchronizes the vsync with the refresh rate of your monitor
-
-	glfwSetKeyCallback(window, key_callback);
-
-	if (glewInit() != GLEW_OK) {
-		std::cout << "Error.  GLEW init() not ok." << std::endl;
+	App* app = new App(config);
+	if (!app->IsValid()) {
+		delete app;
 		glfwTerminate();
 		exit(EXIT_FAILURE);
 	}
 
-	std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
-	std::cout << "OpenGL Vendor : " << glGetString(GL_VENDOR) << std::endl;
-
-	glPointSize(3);
-	glLineWidth(3);
-	glEnable(GL_POINT_SMOOTH);
-	glHint(GL_POINT_SMOOTH_HINT, GL_NICEST);	// Make round points, not square points
-
-	unsigned int vao;
-	GlCall(glGenVertexArrays(1, &vao));
-	GlCall(glBindVertexArray(vao));
-
-	/* Compile the Shader source code */
-	shader = new Shader("res/shaders/Basic.shader");
-	shader->Bind();
-	shader->SetUniform4f("u_Color", 1.0, 0.0, 0.0, 1.0);
-
-	/* alloc the array and index buffers in the GPU */
-	GlCall(glEnableVertexAttribArray(0));
-
-	std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
-	std::cout << "OpenGL Vendor : " << glGetString(GL_VENDOR) << std::endl;
-
-	while (!glfwWindowShouldClose(window)) {
-		/* Render here */
-		glClear(GL_COLOR_BUFFER_BIT);
-
-		/* handle user interaction and draw */
-		drawScene();
-
-		/* Swap front and back buffers */
-		glfwSwapBuffers(window);
-
-		/* Poll for and process events */
-		glfwPollEvents();
+	int status = EXIT_SUCCESS;
+	if (options.BenchmarkFrames > 0)
+		status = app->RunBenchmark(options.BenchmarkFrames, options.BenchmarkOut);
+	else if (options.AllocCheckFrames > 0)
+		status = app->RunAllocCheck(options.AllocCheckFrames);
+	else {
+		/* threads outside the renderer that feed it while it runs */
+		std::atomic<bool> producing(true);
+		std::vector<std::thread> dataThreads;
+		for (int i = 0; i < options.Producers; i++)
+			dataThreads.emplace_back(producerLoop, app, i, &producing);
+		if (options.Editor)
+			dataThreads.emplace_back(editorLoop, app->Versions(), &producing);
+
+		app->Run();
+
+		/* Run() closed the command queue, so no producer is left blocked on it */
+		producing.store(false, std::memory_order_relaxed);
+		for (std::thread& thread : dataThreads)
+			thread.join();
+		app->Report();
 	}
 
-	delete shader;
+	delete app;
+	glfwTerminate();
+	return status;
 }
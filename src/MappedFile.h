@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+/*
+ * Read-only memory mapping of a whole file.  View() stays valid for the
+ * lifetime of the object, so callers can hand out string_views into it
+ * instead of copying the contents.
+ */
+class MappedFile
+{
+private:
+	const char* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#else
+	int m_File;
+#endif
+public:
+	MappedFile(const std::string& filepath);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool IsOpen() const;
+	std::string_view View() const { return std::string_view(m_Data, m_Size); }
+};
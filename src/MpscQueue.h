@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+
+/*
+ * Bounded multi-producer, single-consumer queue after Dmitry Vyukov's bounded
+ * MPMC queue.  Every cell carries a sequence number that says whose turn it is:
+ * a producer claims a cell by advancing the shared tail with one CAS, fills it
+ * and publishes it by bumping the sequence; the consumer reads it in place and
+ * hands the cell back to the producers one lap later.  Producers only contend
+ * on the tail, never on a lock, and a full queue is reported instead of waited
+ * on, so the caller decides what back-pressure means.
+ *
+ * CAPACITY must be a power of two.  The cells are inline; allocate a large
+ * queue on the heap.
+ */
+template<typename T, unsigned int CAPACITY>
+class MpscQueue
+{
+private:
+	static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+	struct alignas(64) Cell
+	{
+		std::atomic<unsigned int> Sequence;  // == position: free for the producer; == position + 1: holds an item
+		T Item;
+	};
+
+	alignas(64) std::atomic<unsigned int> m_Tail;   // next position a producer claims
+	alignas(64) std::atomic<unsigned int> m_Head;   // next position the consumer reads; only the consumer writes it
+	Cell m_Cells[CAPACITY];
+public:
+	MpscQueue()
+		: m_Tail(0), m_Head(0)
+	{
+		for (unsigned int i = 0; i < CAPACITY; i++)
+			m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	/* any thread; false if the queue is full */
+	bool TryPush(const T& item)
+	{
+		unsigned int position = m_Tail.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_Cells[position & (CAPACITY - 1)];
+			int lap = (int)(cell.Sequence.load(std::memory_order_acquire) - position);
+			if (lap == 0) {
+				if (m_Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					cell.Item = item;
+					cell.Sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (lap < 0)
+				return false;   // the consumer has not freed this cell from the previous lap
+			else
+				position = m_Tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	/* consumer only: the oldest item, or nullptr if there is none (or its producer has not finished writing it) */
+	const T* Front() const
+	{
+		unsigned int head = m_Head.load(std::memory_order_relaxed);
+		const Cell& cell = m_Cells[head & (CAPACITY - 1)];
+		if (cell.Sequence.load(std::memory_order_acquire) != head + 1)
+			return nullptr;
+		return &cell.Item;
+	}
+
+	/* consumer only: releases the item Front() returned */
+	void Pop()
+	{
+		unsigned int head = m_Head.load(std::memory_order_relaxed);
+		m_Cells[head & (CAPACITY - 1)].Sequence.store(head + CAPACITY, std::memory_order_release);
+		m_Head.store(head + 1, std::memory_order_release);
+	}
+
+	/* any thread; a snapshot that may be stale by the time it is used */
+	unsigned int Size() const
+	{
+		unsigned int head = m_Head.load(std::memory_order_acquire);
+		unsigned int size = m_Tail.load(std::memory_order_relaxed) - head;
+		return size > CAPACITY ? CAPACITY : size;
+	}
+};
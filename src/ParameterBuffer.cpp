@@ -0,0 +1,114 @@
+#include "ParameterBuffer.h"
+#include "Renderer.h"
+#include "Shader.h"
+
+#include <cstring>
+#include <iostream>
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+ParameterBuffer::ParameterBuffer(unsigned int maxObjects)
+	: m_RendererID(0), m_MaxObjects(maxObjects), m_DirtyBegin(0), m_DirtyEnd(0), m_LastUploadSize(0)
+{
+	/* bound ranges must start on the implementation's offset alignment */
+	int uniformAlignment, storageAlignment;
+	GlCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment));
+	GlCall(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment));
+
+	m_FrameOffset = 0;
+	m_ViewOffset = alignUp(m_FrameOffset + sizeof(FrameParams), uniformAlignment);
+	m_ObjectOffset = alignUp(m_ViewOffset + sizeof(ViewParams), storageAlignment);
+	m_Data.resize(m_ObjectOffset + maxObjects * sizeof(ObjectParams));
+
+	GlCall(glCreateBuffers(1, &m_RendererID));
+	GlCall(glNamedBufferStorage(m_RendererID, m_Data.size(), m_Data.data(), GL_DYNAMIC_STORAGE_BIT));
+}
+
+ParameterBuffer::~ParameterBuffer()
+{
+	GlCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void ParameterBuffer::SetFrame(const FrameParams& params)
+{
+	Write(m_FrameOffset, &params, sizeof(params));
+}
+
+void ParameterBuffer::SetView(const ViewParams& params)
+{
+	Write(m_ViewOffset, &params, sizeof(params));
+}
+
+void ParameterBuffer::SetObject(unsigned int index, const ObjectParams& params)
+{
+	ASSERT(index < m_MaxObjects);
+	Write(m_ObjectOffset + index * sizeof(ObjectParams), &params, sizeof(params));
+}
+
+void ParameterBuffer::Bind() const
+{
+	GlCall(glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_PARAMS_BINDING, m_RendererID, m_FrameOffset, sizeof(FrameParams)));
+	GlCall(glBindBufferRange(GL_UNIFORM_BUFFER, VIEW_PARAMS_BINDING, m_RendererID, m_ViewOffset, sizeof(ViewParams)));
+	GlCall(glBindBufferRange(GL_SHADER_STORAGE_BUFFER, OBJECT_PARAMS_BINDING, m_RendererID, m_ObjectOffset,
+		m_MaxObjects * sizeof(ObjectParams)));
+}
+
+void ParameterBuffer::Flush()
+{
+	m_LastUploadSize = m_DirtyEnd - m_DirtyBegin;
+	if (m_LastUploadSize == 0)
+		return;
+
+	GlCall(glNamedBufferSubData(m_RendererID, m_DirtyBegin, m_LastUploadSize, m_Data.data() + m_DirtyBegin));
+	CountUpload(m_LastUploadSize);
+	m_DirtyBegin = m_DirtyEnd = 0;
+}
+
+bool ParameterBuffer::Validate(const Shader& shader) const
+{
+	struct Expected { const char* name; unsigned int blockInterface; int binding; int size; };
+	const Expected expected[] =
+	{
+		{ "FrameParams", GL_UNIFORM_BLOCK, FRAME_PARAMS_BINDING, (int)sizeof(FrameParams) },
+		{ "ViewParams", GL_UNIFORM_BLOCK, VIEW_PARAMS_BINDING, (int)sizeof(ViewParams) },
+		{ "ObjectParams", GL_SHADER_STORAGE_BLOCK, OBJECT_PARAMS_BINDING, 0 },  // unsized array, no fixed size
+	};
+
+	bool ok = true;
+	for (const Expected& e : expected)
+	{
+		const ShaderBlock* block = shader.GetBlock(e.name);
+		if (!block)
+			continue; // a shader only declares the blocks it reads
+
+		if (block->Interface != e.blockInterface || block->Binding != e.binding || (e.size && block->DataSize != e.size))
+		{
+			std::cout << "Error:  block '" << e.name << "' has binding " << block->Binding << " and size "
+				<< block->DataSize << ", expected binding " << e.binding << " and size " << e.size << "!" << std::endl;
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+void ParameterBuffer::Write(size_t offset, const void* data, size_t size)
+{
+	/* unchanged values do not widen the upload */
+	if (memcmp(m_Data.data() + offset, data, size) == 0)
+		return;
+
+	memcpy(m_Data.data() + offset, data, size);
+	if (m_DirtyBegin == m_DirtyEnd)
+	{
+		m_DirtyBegin = offset;
+		m_DirtyEnd = offset + size;
+		return;
+	}
+	if (offset < m_DirtyBegin)
+		m_DirtyBegin = offset;
+	if (offset + size > m_DirtyEnd)
+		m_DirtyEnd = offset + size;
+}
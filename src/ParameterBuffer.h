@@ -0,0 +1,44 @@
+#pragma once
+#include "ShaderParams.h"
+
+#include <vector>
+
+class Shader;
+
+/*
+ * One GL buffer holding the frame and view uniform blocks and the per-object
+ * storage block.  Writes go to a CPU copy and widen a dirty byte range; Flush()
+ * sends that whole range with a single glNamedBufferSubData, so a frame costs at
+ * most one upload no matter how many parameters changed.
+ */
+class ParameterBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_MaxObjects;
+	size_t m_FrameOffset;
+	size_t m_ViewOffset;
+	size_t m_ObjectOffset;
+	std::vector<unsigned char> m_Data;
+	size_t m_DirtyBegin;
+	size_t m_DirtyEnd;
+	size_t m_LastUploadSize;
+public:
+	ParameterBuffer(unsigned int maxObjects);
+	~ParameterBuffer();
+
+	void SetFrame(const FrameParams& params);
+	void SetView(const ViewParams& params);
+	void SetObject(unsigned int index, const ObjectParams& params);
+
+	/* binds each block to its ParamBinding; the bindings stay until another buffer takes them */
+	void Bind() const;
+	void Flush();
+	/* reports blocks in the shader whose binding or size disagrees with ShaderParams.h */
+	bool Validate(const Shader& shader) const;
+
+	unsigned int MaxObjects() const { return m_MaxObjects; }
+	size_t LastUploadSize() const { return m_LastUploadSize; }
+private:
+	void Write(size_t offset, const void* data, size_t size);
+};
@@ -9,9 +9,9 @@ Points::~Points()
 {
 }
 
-void Points::Draw()
+void Points::Draw(unsigned int object)
 {
 	GlCall(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0)); // tell GL the vertices start at idx 0 and are 2 floats long.
-	GlCall(glDrawElements(GL_POINTS, m_Vbuffer.Count(), GL_UNSIGNED_INT, nullptr)); // GL state machine knows the data to be drawn is in buffer.
+	GlCall(glDrawElementsInstancedBaseInstance(GL_POINTS, m_Vbuffer.Count() / 2, GL_UNSIGNED_INT, nullptr, 1, object)); // GL state machine knows the data to be drawn is in buffer.
+	CountDraw(m_Vbuffer.Count() / 2);
 }
- 
\ No newline at end of file
@@ -11,5 +11,6 @@ private:
 public:
 	Points(VertexBuffer& vBuffer, IndexBuffer& iBuffer);
 	~Points();
-	void Draw();
+	/* object is the ObjectParams index the shader reads through gl_BaseInstance */
+	void Draw(unsigned int object);
 };
@@ -0,0 +1,200 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+	struct ProfileEvent
+	{
+		const char* Name;
+		uint64_t Start;
+		uint64_t End;
+	};
+
+	/* Written only by its thread.  Count is published with release so the thread
+	   writing the trace sees complete events; Generation is published after the
+	   reset it guards, so a buffer of the current capture never shows stale events. */
+	struct ThreadBuffer
+	{
+		static const uint32_t CAPACITY = 1 << 16;
+
+		ProfileEvent Events[CAPACITY];
+		std::atomic<uint32_t> Count{ 0 };
+		std::atomic<uint32_t> Dropped{ 0 };
+		std::atomic<uint32_t> Generation{ 0 };
+		std::atomic<const char*> Name{ nullptr };
+		int ThreadID = 0;
+		bool InUse = false;                              // guarded by registryMutex
+	};
+
+	std::mutex registryMutex;                            // only taken when a thread records its first event or exits
+	std::vector<std::unique_ptr<ThreadBuffer>> registry;
+	std::atomic<uint32_t> generation{ 0 };              // bumped per capture; stale buffers reset themselves
+	thread_local const char* threadName = nullptr;
+
+	/* marks the buffer free for the next new thread when its thread exits */
+	struct ThreadBufferOwner
+	{
+		ThreadBuffer* Buffer = nullptr;
+
+		~ThreadBufferOwner()
+		{
+			if (!Buffer)
+				return;
+			std::lock_guard<std::mutex> lock(registryMutex);
+			Buffer->InUse = false;
+		}
+	};
+	thread_local ThreadBufferOwner threadBuffer;
+
+	int framesLeft = 0;
+	std::string tracePath;
+
+	ThreadBuffer* getThreadBuffer()
+	{
+		if (!threadBuffer.Buffer)
+		{
+			/* a new thread appends to the events an exited one recorded in this capture;
+			   they never overlap in time, so they can share the trace's tid */
+			std::lock_guard<std::mutex> lock(registryMutex);
+			for (const auto& buffer : registry)
+			{
+				if (!buffer->InUse)
+				{
+					threadBuffer.Buffer = buffer.get();
+					break;
+				}
+			}
+			if (!threadBuffer.Buffer)
+			{
+				registry.push_back(std::make_unique<ThreadBuffer>());
+				registry.back()->ThreadID = (int)registry.size();
+				threadBuffer.Buffer = registry.back().get();
+			}
+			threadBuffer.Buffer->InUse = true;
+			threadBuffer.Buffer->Name.store(threadName, std::memory_order_relaxed);
+		}
+		return threadBuffer.Buffer;
+	}
+
+}
+
+std::atomic<bool> Profiler::s_Enabled{ false };
+
+uint64_t Profiler::Now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+	uint32_t current = generation.load(std::memory_order_acquire);
+	if (buffer->Generation.load(std::memory_order_relaxed) != current)
+	{
+		buffer->Count.store(0, std::memory_order_relaxed);
+		buffer->Dropped.store(0, std::memory_order_relaxed);
+		buffer->Generation.store(current, std::memory_order_release);
+	}
+
+	uint32_t count = buffer->Count.load(std::memory_order_relaxed);
+	if (count == ThreadBuffer::CAPACITY)
+	{
+		buffer->Dropped.store(buffer->Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return;
+	}
+	buffer->Events[count] = { name, start, end };
+	buffer->Count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	threadName = name;
+	if (threadBuffer.Buffer)
+		threadBuffer.Buffer->Name.store(name, std::memory_order_relaxed);
+}
+
+void Profiler::Capture(int frames, const std::string& path)
+{
+	if (IsEnabled() || frames <= 0)
+		return;
+
+	std::cout << "Profiler: capturing " << frames << " frames to " << path << std::endl;
+	framesLeft = frames;
+	tracePath = path;
+	generation.fetch_add(1, std::memory_order_release);
+	s_Enabled.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::EndFrame()
+{
+	if (!IsEnabled() || --framesLeft > 0)
+		return;
+
+	s_Enabled.store(false, std::memory_order_relaxed);
+	WriteTrace();
+}
+
+void Profiler::WriteTrace()
+{
+	std::ofstream out(tracePath);
+	if (!out)
+	{
+		std::cout << "Profiler: cannot write " << tracePath << std::endl;
+		return;
+	}
+
+	uint32_t current = generation.load(std::memory_order_acquire);
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	uint64_t origin = UINT64_MAX;
+	for (const auto& buffer : registry)
+	{
+		uint32_t count = buffer->Generation.load(std::memory_order_acquire) == current ? buffer->Count.load(std::memory_order_acquire) : 0;
+		for (uint32_t i = 0; i < count; i++)
+			origin = buffer->Events[i].Start < origin ? buffer->Events[i].Start : origin;
+	}
+
+	/* complete ("X") events with microsecond timestamps relative to the first event */
+	size_t written = 0;
+	uint32_t dropped = 0;
+	out << std::fixed;
+	out.precision(3);
+	out << "{\"traceEvents\":[\n";
+	const char* separator = "";
+	for (const auto& buffer : registry)
+	{
+		const char* name = buffer->Name.load(std::memory_order_relaxed);
+		if (name)
+		{
+			out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadID
+				<< ",\"args\":{\"name\":\"" << name << "\"}}";
+			separator = ",\n";
+		}
+
+		if (buffer->Generation.load(std::memory_order_acquire) != current)
+			continue;
+		uint32_t count = buffer->Count.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const ProfileEvent& event = buffer->Events[i];
+			out << separator << "{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadID
+				<< ",\"ts\":" << (event.Start - origin) / 1000.0 << ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+			separator = ",\n";
+		}
+		written += count;
+		dropped += buffer->Dropped.load(std::memory_order_relaxed);
+	}
+	out << "\n]}\n";
+
+	std::cout << "Profiler: wrote " << written << " zones to " << tracePath;
+	if (dropped)
+		std::cout << " (" << dropped << " dropped, buffer full)";
+	std::cout << std::endl;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * CPU zone profiler.  PROFILE_SCOPE("name") times the rest of the enclosing
+ * block into a per-thread buffer; only the owning thread writes a buffer, so
+ * recording takes no lock.  A thread's buffer is handed to the next new thread
+ * once it exits, so short-lived workers do not add buffers.  While no capture
+ * is running a zone costs one relaxed load and a well-predicted branch, so the
+ * zones stay compiled into release builds.
+ *
+ * Capture(frames, path) records the next `frames` frames (counted by EndFrame())
+ * and writes them as a Chrome/Perfetto trace (chrome://tracing, ui.perfetto.dev).
+ */
+class Profiler
+{
+private:
+	static std::atomic<bool> s_Enabled;
+public:
+	static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+	static uint64_t Now();
+	static void Record(const char* name, uint64_t start, uint64_t end);
+	static void SetThreadName(const char* name);
+
+	static void Capture(int frames, const std::string& path);
+	/* called once per frame by the thread that owns the frame loop */
+	static void EndFrame();
+private:
+	static void WriteTrace();
+};
+
+/* m_Name stays null outside a capture; the zone never escapes, so the compiler folds the destructor's check into the constructor's branch */
+class ProfileZone
+{
+private:
+	const char* m_Name;
+	uint64_t m_Start;
+public:
+	ProfileZone(const char* name) : m_Name(nullptr), m_Start(0)
+	{
+		if (Profiler::IsEnabled()) {
+			m_Name = name;
+			m_Start = Profiler::Now();
+		}
+	}
+	~ProfileZone()
+	{
+		if (m_Name)
+			Profiler::Record(m_Name, m_Start, Profiler::Now());
+	}
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
@@ -0,0 +1,48 @@
+#include "ProgramPipeline.h"
+#include "Renderer.h"
+#include "Shader.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <alloca.h>
+#endif
+#include <iostream>
+
+ProgramPipeline::ProgramPipeline(const Shader& vertexStage, const Shader& fragmentStage)
+{
+	GlCall(glCreateProgramPipelines(1, &m_RendererID));
+	GlCall(glUseProgramStages(m_RendererID, GL_VERTEX_SHADER_BIT, vertexStage.GetRendererID()));
+	GlCall(glUseProgramStages(m_RendererID, GL_FRAGMENT_SHADER_BIT, fragmentStage.GetRendererID()));
+
+	/* catches stages whose outputs and inputs do not match */
+	int valid;
+	GlCall(glValidateProgramPipeline(m_RendererID));
+	GlCall(glGetProgramPipelineiv(m_RendererID, GL_VALIDATE_STATUS, &valid));
+	if (valid == GL_FALSE)
+	{
+		int length;
+		GlCall(glGetProgramPipelineiv(m_RendererID, GL_INFO_LOG_LENGTH, &length));
+		char* infoLog = (char*)alloca((length + 1) * sizeof(char));
+		infoLog[0] = '\0';
+		GlCall(glGetProgramPipelineInfoLog(m_RendererID, length + 1, &length, infoLog));
+		std::cout << "Warning:  program pipeline did not validate!" << std::endl;
+		std::cout << infoLog << std::endl;
+	}
+}
+
+ProgramPipeline::~ProgramPipeline()
+{
+	GlCall(glDeleteProgramPipelines(1, &m_RendererID));
+}
+
+void ProgramPipeline::Bind() const
+{
+	GlCall(glUseProgram(0)); // a program made current with glUseProgram would take precedence
+	GlCall(glBindProgramPipeline(m_RendererID));
+}
+
+void ProgramPipeline::Unbind() const
+{
+	GlCall(glBindProgramPipeline(0));
+}
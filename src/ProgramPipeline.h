@@ -0,0 +1,19 @@
+#pragma once
+
+class Shader;
+
+/*
+ * A program pipeline object combining a separable vertex stage and a separable
+ * fragment stage.  Switching between combinations costs a bind, not a link.
+ */
+class ProgramPipeline
+{
+private:
+	unsigned int m_RendererID;
+public:
+	ProgramPipeline(const Shader& vertexStage, const Shader& fragmentStage);
+	~ProgramPipeline();
+
+	void Bind() const;
+	void Unbind() const;
+};
@@ -0,0 +1,118 @@
+#include "RenderCommands.h"
+#include "Renderer.h"
+#include "SceneStore.h"
+#include "ParameterBuffer.h"
+#include "Profiler.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+RenderCommandQueue::RenderCommandQueue(QueueFullPolicy policy)
+	: m_Policy(policy), m_Closed(false), m_Submitted(0), m_Dropped(0), m_Waited(0), m_Blocked(0)
+{
+}
+
+bool RenderCommandQueue::Submit(RenderCommand& command)
+{
+	ASSERT(command.Type != RenderCommand::SET_GEOMETRY || command.VertexCount <= RenderCommand::MAX_VERTICES);
+	command.Queued = Clock::now();
+	if (m_Closed.load(std::memory_order_relaxed))
+		return false;
+	if (m_Queue.TryPush(command)) {
+		m_Submitted.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	if (m_Policy == QueueFullPolicy::Drop) {
+		m_Dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	m_Waited.fetch_add(1, std::memory_order_relaxed);
+
+	bool pushed = false;
+	if (m_Policy == QueueFullPolicy::Spin) {
+		while (!(pushed = m_Queue.TryPush(command)) && !m_Closed.load(std::memory_order_relaxed))
+			std::this_thread::yield();
+	}
+	else {
+		std::unique_lock<std::mutex> lock(m_BlockMutex);
+		m_Blocked.fetch_add(1, std::memory_order_relaxed);
+		/* pairs with the fence in WakeProducers(): either the drain sees this producer or this sees the free cells */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		m_Drained.wait(lock, [&] { return (pushed = m_Queue.TryPush(command)) || m_Closed.load(std::memory_order_relaxed); });
+		m_Blocked.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	if (pushed)
+		m_Submitted.fetch_add(1, std::memory_order_relaxed);
+	else
+		m_Dropped.fetch_add(1, std::memory_order_relaxed);
+	return pushed;
+}
+
+void RenderCommandQueue::Close()
+{
+	m_Closed.store(true, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(m_BlockMutex);
+	m_Drained.notify_all();
+}
+
+void RenderCommandQueue::WakeProducers()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_Blocked.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<std::mutex> lock(m_BlockMutex);
+		m_Drained.notify_all();
+	}
+}
+
+unsigned int RenderCommandQueue::Drain(SceneStore& scene, ParameterBuffer& params)
+{
+	PROFILE_FUNCTION();
+	return Drain([&](const RenderCommand& command) {
+		switch (command.Type) {
+			case RenderCommand::SET_GEOMETRY:
+				scene.SetGeometry(command.Entity, command.Positions, command.VertexCount, 2);
+				break;
+			case RenderCommand::SET_COLOR:
+				scene.SetColor(command.Entity, command.Color);
+				params.SetObject(command.Entity, command.Color);
+				break;
+			case RenderCommand::SET_ENABLED:
+				scene.SetEnabled(command.Entity, command.Enabled);
+				break;
+		}
+	});
+}
+
+void RenderCommandQueue::Report() const
+{
+	std::cout << "Render commands (" << PolicyName(m_Policy) << " when full): " << Submitted() << " submitted, "
+		<< Dropped() << " dropped, " << Waited() << " waited for room" << std::endl;
+	if (m_QueueLatency.Count())
+		std::cout << "  time in queue: avg " << m_QueueLatency.Mean() << " us, median " << m_QueueLatency.Percentile(50)
+			<< " us, 99% " << m_QueueLatency.Percentile(99) << " us, max " << m_QueueLatency.Max() << " us" << std::endl;
+}
+
+const char* RenderCommandQueue::PolicyName(QueueFullPolicy policy)
+{
+	switch (policy) {
+		case QueueFullPolicy::Drop:  return "drop";
+		case QueueFullPolicy::Spin:  return "spin";
+		case QueueFullPolicy::Block: return "block";
+	}
+	return "unknown";
+}
+
+bool RenderCommandQueue::ParsePolicy(const char* name, QueueFullPolicy& policy)
+{
+	const QueueFullPolicy policies[] = { QueueFullPolicy::Drop, QueueFullPolicy::Spin, QueueFullPolicy::Block };
+	for (QueueFullPolicy candidate : policies) {
+		if (strcmp(name, PolicyName(candidate)) == 0) {
+			policy = candidate;
+			return true;
+		}
+	}
+	return false;
+}
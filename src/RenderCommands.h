@@ -0,0 +1,108 @@
+#pragma once
+#include "MpscQueue.h"
+#include "LatencyHistogram.h"
+#include "ShaderParams.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+class SceneStore;
+class ParameterBuffer;
+
+/* A scene update from any thread.  The payload is inline, so queuing one never allocates. */
+struct RenderCommand
+{
+	enum CommandType : uint8_t
+	{
+		SET_GEOMETRY,   // Positions replace the vertices of an entity made with SceneStore::Reserve()
+		SET_COLOR,
+		SET_ENABLED
+	};
+	static const unsigned int MAX_VERTICES = 32;   // 2-D positions
+
+	CommandType Type;
+	bool Enabled;
+	uint16_t VertexCount;
+	unsigned int Entity;
+	std::chrono::steady_clock::time_point Queued;  // set by Submit()
+	ObjectParams Color;
+	float Positions[MAX_VERTICES * 2];
+};
+
+/* What Submit() does when the queue is full. */
+enum class QueueFullPolicy
+{
+	Drop,    // return false at once; the command is lost
+	Spin,    // retry, yielding the time slice in between
+	Block    // sleep until the GL thread drains the queue
+};
+
+/*
+ * Lets any thread send draw and update commands to the renderer.  Producers
+ * push into a bounded lock-free MPSC queue; the GL thread calls Drain() once per
+ * frame and applies everything queued so far.  The time each command spent in
+ * the queue is recorded when it is drained.
+ */
+class RenderCommandQueue
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	static const unsigned int CAPACITY = 1024;
+private:
+	MpscQueue<RenderCommand, CAPACITY> m_Queue;
+	QueueFullPolicy m_Policy;
+	std::atomic<bool> m_Closed;
+	std::atomic<uint64_t> m_Submitted;
+	std::atomic<uint64_t> m_Dropped;
+	std::atomic<uint64_t> m_Waited;    // submits that found the queue full and waited
+	std::atomic<int> m_Blocked;        // producers asleep in Submit()
+	std::mutex m_BlockMutex;
+	std::condition_variable m_Drained;
+	LatencyHistogram m_QueueLatency;   // us from Submit() to Drain(); written by the GL thread only
+public:
+	explicit RenderCommandQueue(QueueFullPolicy policy);
+	RenderCommandQueue(const RenderCommandQueue&) = delete;
+	RenderCommandQueue& operator=(const RenderCommandQueue&) = delete;
+
+	/* any thread; false if the command was dropped or the queue is closed */
+	bool Submit(RenderCommand& command);
+	/* wakes blocked producers and fails every later Submit(); call before joining the producers */
+	void Close();
+
+	/* GL thread: applies the commands queued so far to the scene and the object parameters */
+	unsigned int Drain(SceneStore& scene, ParameterBuffer& params);
+	/* consumer only: passes each command queued so far to apply */
+	template<typename F>
+	unsigned int Drain(const F& apply)
+	{
+		Clock::time_point now = Clock::now();
+		unsigned int drained = 0;
+		/* at most one lap, so producers that keep up cannot hold the frame here */
+		for (const RenderCommand* command; drained < CAPACITY && (command = m_Queue.Front()); drained++) {
+			m_QueueLatency.Record(now > command->Queued
+				? (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - command->Queued).count() : 0);
+			apply(*command);
+			m_Queue.Pop();
+		}
+		if (drained)
+			WakeProducers();
+		return drained;
+	}
+
+	QueueFullPolicy Policy() const { return m_Policy; }
+	unsigned int Size() const { return m_Queue.Size(); }
+	uint64_t Submitted() const { return m_Submitted.load(std::memory_order_relaxed); }
+	uint64_t Dropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+	uint64_t Waited() const { return m_Waited.load(std::memory_order_relaxed); }
+	const LatencyHistogram& QueueLatency() const { return m_QueueLatency; }
+	void Report() const;
+
+	static const char* PolicyName(QueueFullPolicy policy);
+	/* "drop", "spin" or "block"; false for anything else */
+	static bool ParsePolicy(const char* name, QueueFullPolicy& policy);
+private:
+	void WakeProducers();
+};
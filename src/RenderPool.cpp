@@ -0,0 +1,285 @@
+#include "RenderPool.h"
+#include "Renderer.h"
+#include "SceneStore.h"
+#include "Shader.h"
+#include "ShaderLibrary.h"
+#include "ParameterBuffer.h"
+#include "FrameBuffer.h"
+#include "Profiler.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+static const size_t FRAME_ARENA_BYTES = 16 * 1024;  // a chart records three draws
+
+/* Everything a worker draws with; created on the main thread, used only by the worker's thread after that. */
+struct RenderPool::Worker
+{
+	GLFWwindow* Window;
+	unsigned int VertexArray;
+	ShaderLibrary* Shaders;
+	Shader* Basic;
+	ProgramPipeline* PointPipeline;
+	SceneStore* Scene;
+	ParameterBuffer* Params;
+	FrameBuffer* Target;
+	FrameArena* Arena;
+	unsigned int Line;             // entities in Scene
+	unsigned int Markers;
+	std::vector<unsigned char> Pixels;
+	std::vector<float> Positions;
+	WorkerStats Stats;
+};
+
+/* 64-bit FNV-1a */
+static uint64_t hashPixels(const unsigned char* data, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 1099511628211ull;
+	return hash;
+}
+
+/* binary PPM, top row first; the pixels come from glReadPixels, bottom row first */
+static bool writePpm(const std::string& path, int width, int height, const unsigned char* rgba) {
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file)
+		return false;
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	std::vector<unsigned char> row(width * 3);
+	for (int y = height - 1; y >= 0; y--) {
+		const unsigned char* source = rgba + (size_t)y * width * 4;
+		for (int x = 0; x < width; x++) {
+			row[x * 3] = source[x * 4];
+			row[x * 3 + 1] = source[x * 4 + 1];
+			row[x * 3 + 2] = source[x * 4 + 2];
+		}
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	return fclose(file) == 0;
+}
+
+RenderPool::RenderPool(unsigned int workers, unsigned int capacity, int width, int height)
+	: m_Width(width), m_Height(height), m_Capacity(capacity), m_Closed(false), m_Submitted(0), m_Waited(0), m_Valid(false)
+{
+	/* contexts can only be made on the main thread, so all of them are made here before any worker starts */
+	for (unsigned int i = 0; i < workers; i++) {
+		Worker* worker = new Worker();
+		m_Workers.push_back(worker);
+		worker->Window = CreateGlWindow(width, height, false);
+		if (!worker->Window)
+			return;
+
+		glPointSize(3);
+		glLineWidth(2);
+		GlCall(glGenVertexArrays(1, &worker->VertexArray));
+		GlCall(glBindVertexArray(worker->VertexArray));
+		GlCall(glEnableVertexAttribArray(0));
+
+		worker->Shaders = new ShaderLibrary();
+		worker->Shaders->Add("Basic", "res/shaders/Basic.shader");
+		worker->Shaders->AddStage("Plain", "res/shaders/stages/Plain.shader");
+		worker->Shaders->AddStage("SdfPoint", "res/shaders/stages/SdfPoint.shader");
+		worker->Shaders->Build();
+		worker->Basic = worker->Shaders->Get("Basic");
+		worker->PointPipeline = worker->Shaders->GetPipeline("Plain", "SdfPoint");
+		if (!worker->Basic || !worker->PointPipeline) {
+			glfwMakeContextCurrent(NULL);
+			return;
+		}
+		worker->Basic->Bind();
+
+		/* the axes are fixed; the line and its markers get each job's values */
+		const float axes[] = { -0.9f, 0.9f, -0.9f, -0.9f, 0.9f, -0.9f };
+		worker->Scene = new SceneStore(3);
+		worker->Scene->Add(SceneStore::KIND_LINES, axes, 3, 2, { { 0.6f, 0.6f, 0.6f, 1.0f } });
+		worker->Line = worker->Scene->Reserve(SceneStore::KIND_LINES, MAX_POINTS, { { 1.0f, 1.0f, 1.0f, 1.0f } });
+		worker->Markers = worker->Scene->Reserve(SceneStore::KIND_POINTS, MAX_POINTS, { { 1.0f, 1.0f, 1.0f, 1.0f } });
+		worker->Scene->Upload();
+
+		worker->Params = new ParameterBuffer(worker->Scene->Count());
+		if (!worker->Params->Validate(*worker->Basic)) {
+			glfwMakeContextCurrent(NULL);
+			return;
+		}
+		ViewParams view = {};
+		view.ViewProjection[0] = view.ViewProjection[5] = view.ViewProjection[10] = view.ViewProjection[15] = 1.0f;
+		view.Viewport[2] = (float)width;
+		view.Viewport[3] = (float)height;
+		worker->Params->SetView(view);
+		worker->Scene->WriteParams(*worker->Params);
+		worker->Params->Bind();
+
+		worker->Target = new FrameBuffer(width, height);
+		if (!worker->Target->IsComplete()) {
+			std::cout << "Error:  render pool framebuffer is incomplete" << std::endl;
+			glfwMakeContextCurrent(NULL);
+			return;
+		}
+		worker->Arena = new FrameArena(FRAME_ARENA_BYTES);
+		worker->Pixels.resize((size_t)width * height * 4);
+		worker->Positions.resize(MAX_POINTS * 2);
+		glfwMakeContextCurrent(NULL);
+	}
+
+	m_Valid = true;
+	for (Worker* worker : m_Workers)
+		m_Threads.emplace_back(&RenderPool::WorkerLoop, this, worker);
+}
+
+RenderPool::~RenderPool()
+{
+	Finish();
+	for (Worker* worker : m_Workers) {
+		if (worker->Window) {
+			glfwMakeContextCurrent(worker->Window);
+			delete worker->Arena;
+			delete worker->Target;
+			delete worker->Params;
+			delete worker->Scene;
+			delete worker->Shaders;
+			if (worker->VertexArray)
+				glDeleteVertexArrays(1, &worker->VertexArray);
+			glfwMakeContextCurrent(NULL);
+			glfwDestroyWindow(worker->Window);
+		}
+		delete worker;
+	}
+}
+
+bool RenderPool::Submit(ChartJob job)
+{
+	ASSERT(job.Values.size() <= MAX_POINTS);
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	if (m_Jobs.size() >= m_Capacity && !m_Closed) {
+		m_Waited++;
+		m_RoomReady.wait(lock, [&] { return m_Jobs.size() < m_Capacity || m_Closed; });
+	}
+	if (m_Closed)
+		return false;
+	m_Jobs.push_back(std::move(job));
+	m_Submitted++;
+	lock.unlock();
+	m_JobReady.notify_one();
+	return true;
+}
+
+void RenderPool::Finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Closed = true;
+	}
+	/* the workers empty the queue before they see the pool is closed */
+	m_JobReady.notify_all();
+	m_RoomReady.notify_all();
+	for (std::thread& thread : m_Threads)
+		thread.join();
+	m_Threads.clear();
+}
+
+const RenderPool::WorkerStats& RenderPool::Stats(unsigned int worker) const
+{
+	return m_Workers[worker]->Stats;
+}
+
+void RenderPool::Report() const
+{
+	std::cout << "Render pool: " << m_Workers.size() << " workers, " << m_Submitted << " charts of " << m_Width << "x"
+		<< m_Height << ", queue of " << m_Capacity << " full " << m_Waited << " times" << std::endl;
+	for (size_t i = 0; i < m_Workers.size(); i++) {
+		const WorkerStats& stats = m_Workers[i]->Stats;
+		double totalMs = stats.BusyMs + stats.IdleMs;
+		std::cout << "  worker " << i << ": " << stats.Jobs << " charts";
+		if (stats.Failed)
+			std::cout << " (" << stats.Failed << " not written)";
+		std::cout << ", " << (totalMs > 0.0 ? stats.Jobs * 1000.0 / totalMs : 0.0) << " charts/s, busy "
+			<< (totalMs > 0.0 ? 100.0 * stats.BusyMs / totalMs : 0.0) << "%, draw p50 " << stats.DrawUs.Percentile(50)
+			<< " us p99 " << stats.DrawUs.Percentile(99) << " us, write p50 " << stats.WriteUs.Percentile(50)
+			<< " us p99 " << stats.WriteUs.Percentile(99) << " us" << std::endl;
+	}
+}
+
+/* A worker owns its context for as long as the pool runs. */
+void RenderPool::WorkerLoop(Worker* worker)
+{
+	typedef std::chrono::steady_clock Clock;
+	Profiler::SetThreadName("render pool");
+	glfwMakeContextCurrent(worker->Window);
+	worker->Target->Bind();
+
+	WorkerStats& stats = worker->Stats;
+	for (;;) {
+		ChartJob job;
+		Clock::time_point waitStart = Clock::now();
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobReady.wait(lock, [&] { return !m_Jobs.empty() || m_Closed; });
+			if (m_Jobs.empty())
+				break;
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+		m_RoomReady.notify_one();
+		Clock::time_point start = Clock::now();
+		stats.IdleMs += std::chrono::duration<double, std::milli>(start - waitStart).count();
+
+		if (!Draw(*worker, job)) {
+			stats.Failed++;
+			std::cout << "Error:  cannot write " + job.OutPath + "\n" << std::flush;
+		}
+		stats.Jobs++;
+		stats.BusyMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	worker->Target->Unbind();
+	glfwMakeContextCurrent(NULL);
+}
+
+/* draws the chart, reads it back and writes it; false if the file could not be written */
+bool RenderPool::Draw(Worker& worker, const ChartJob& job)
+{
+	PROFILE_FUNCTION();
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	unsigned int count = (unsigned int)job.Values.size();
+	for (unsigned int i = 0; i < count; i++) {
+		float value = std::min(std::max(job.Values[i], 0.0f), 1.0f);
+		worker.Positions[i * 2] = count > 1 ? -0.85f + 1.7f * i / (count - 1) : 0.0f;
+		worker.Positions[i * 2 + 1] = -0.85f + 1.7f * value;
+	}
+	worker.Scene->SetGeometry(worker.Line, worker.Positions.data(), count, 2);
+	worker.Scene->SetGeometry(worker.Markers, worker.Positions.data(), count, 2);
+	worker.Scene->SetColor(worker.Line, job.Color);
+	worker.Params->SetObject(worker.Line, job.Color);
+	worker.Params->Flush();
+
+	worker.Arena->BeginFrame();
+	GlCall(glClear(GL_COLOR_BUFFER_BIT));
+	worker.Scene->Cull(-1.0f, -1.0f, 1.0f, 1.0f);
+	{
+		CommandList commands{ ArenaAllocator<DrawCommand>(*worker.Arena) };
+		worker.Scene->Record(commands, SceneStore::KIND_LINES, GL_LINE_STRIP);
+		::Submit(commands);
+	}
+	{
+		CommandList commands{ ArenaAllocator<DrawCommand>(*worker.Arena) };
+		worker.Scene->Record(commands, SceneStore::KIND_POINTS, GL_POINTS);
+		worker.PointPipeline->Bind();
+		::Submit(commands);
+		worker.Basic->Bind();
+	}
+
+	worker.Target->ReadPixels(worker.Pixels.data());
+	Clock::time_point drawn = Clock::now();
+	worker.Stats.DrawUs.Record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(drawn - start).count());
+	worker.Stats.Checksum += hashPixels(worker.Pixels.data(), worker.Pixels.size());
+
+	if (job.OutPath.empty())
+		return true;
+	bool written = writePpm(job.OutPath, m_Width, m_Height, worker.Pixels.data());
+	worker.Stats.WriteUs.Record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - drawn).count());
+	return written;
+}
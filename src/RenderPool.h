@@ -0,0 +1,89 @@
+#pragma once
+#include "LatencyHistogram.h"
+#include "ShaderParams.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+/* One chart to draw offline: a line through the values with a marker on each. */
+struct ChartJob
+{
+	std::string OutPath;          // binary PPM; nothing is written when empty
+	std::vector<float> Values;    // 0 is the bottom of the plot, 1 the top; at most RenderPool::MAX_POINTS
+	ObjectParams Color;           // of the line
+};
+
+/*
+ * Draws charts into image files on worker threads.  Each worker has its own
+ * hidden window and GL context, and its own shaders, scene, parameter buffer
+ * and offscreen target, so the workers share nothing but the job queue.
+ *
+ * Submit() adds to a bounded queue and blocks while it is full, which keeps a
+ * fast producer from running ahead of the workers.  Every worker takes the next
+ * job as soon as it is done with the last one.  Contexts are created and
+ * destroyed by the constructor and destructor, which must run on the main
+ * thread; Submit() may be called from any thread.
+ */
+class RenderPool
+{
+public:
+	static const unsigned int MAX_POINTS = 256;
+
+	struct WorkerStats
+	{
+		uint64_t Jobs;
+		uint64_t Failed;           // images that could not be written
+		uint64_t Checksum;         // sum of the image hashes; the same for any split of the same jobs
+		double BusyMs;             // drawing, reading back and writing
+		double IdleMs;             // waiting for a job
+		LatencyHistogram DrawUs;   // per image, until its pixels are read back
+		LatencyHistogram WriteUs;  // per image, writing the file
+	};
+private:
+	struct Worker;
+
+	int m_Width;
+	int m_Height;
+	unsigned int m_Capacity;
+	std::vector<Worker*> m_Workers;
+	std::vector<std::thread> m_Threads;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_JobReady;
+	std::condition_variable m_RoomReady;
+	std::deque<ChartJob> m_Jobs;
+	bool m_Closed;
+	uint64_t m_Submitted;
+	uint64_t m_Waited;             // Submit() calls that found the queue full
+	bool m_Valid;
+public:
+	/* capacity is the number of jobs that may wait in the queue */
+	RenderPool(unsigned int workers, unsigned int capacity, int width, int height);
+	~RenderPool();
+	RenderPool(const RenderPool&) = delete;
+	RenderPool& operator=(const RenderPool&) = delete;
+
+	/* false if a worker's context or shaders could not be created; nothing else may be called then */
+	bool IsValid() const { return m_Valid; }
+
+	/* any thread; waits for room in the queue, false once Finish() was called */
+	bool Submit(ChartJob job);
+	/* waits until every submitted job is done, then stops the workers */
+	void Finish();
+
+	/* after Finish() */
+	unsigned int Workers() const { return (unsigned int)m_Workers.size(); }
+	const WorkerStats& Stats(unsigned int worker) const;
+	uint64_t Waited() const { return m_Waited; }
+	void Report() const;
+private:
+	void WorkerLoop(Worker* worker);
+	bool Draw(Worker& worker, const ChartJob& job);
+};
@@ -1,6 +1,12 @@
 #include "Renderer.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include <GLFW/glfw3.h>
+#include <cstdlib>
 #include <iostream>
 
+thread_local RenderStats g_RenderStats = {};
+
 void GlClearError() {
 	while (glGetError() != GL_NO_ERROR);
 }
@@ -12,4 +18,70 @@ bool GlLogCall(const char* function, const char* file, int line) {
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+static void issue(const DrawCommand& command) {
+	const void* first = (const void*)(command.First * sizeof(unsigned int));
+	GlCall(glDrawElementsInstancedBaseInstance(command.Mode, command.Count, GL_UNSIGNED_INT, first, 1, command.Object));
+	CountDraw(command.Count);
+}
+
+void Submit(const CommandList& commands) {
+	const VertexBuffer* vertices = nullptr;
+	const IndexBuffer* indices = nullptr;
+	unsigned int components = 0;
+	for (const DrawCommand& command : commands) {
+		if (command.Vertices != vertices || command.Components != components) {
+			command.Vertices->Bind();
+			GlCall(glVertexAttribPointer(0, command.Components, GL_FLOAT, GL_FALSE, 0, 0));
+			vertices = command.Vertices;
+			components = command.Components;
+		}
+		if (command.Indices != indices) {
+			command.Indices->Bind();
+			indices = command.Indices;
+		}
+		issue(command);
+	}
+}
+
+bool HasDisplay() {
+#if defined(_WIN32) || defined(__APPLE__)
+	return true;
+#else
+	return getenv("DISPLAY") || getenv("WAYLAND_DISPLAY");
+#endif
+}
+
+GLFWwindow* CreateGlWindow(int width, int height, bool visible) {
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	//glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+
+	bool nullPlatform = glfwGetPlatform() == GLFW_PLATFORM_NULL;
+	if (nullPlatform)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);  // e.g. Mesa with EGL_PLATFORM=surfaceless
+
+	GLFWwindow* window = glfwCreateWindow(width, height, "SimpleDraw", NULL, NULL);
+	if (!window && nullPlatform) {
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		window = glfwCreateWindow(width, height, "SimpleDraw", NULL, NULL);
+	}
+	if (!window)
+		return nullptr;
+	glfwMakeContextCurrent(window);
+
+	/* A GLEW built for GLX reports the missing X display under EGL or OSMesa, but the
+	   GL entry points still load through the shared dispatch, so that error is harmless. */
+	glewExperimental = GL_TRUE;
+	GLenum glewStatus = glewInit();
+	if (glewStatus != GLEW_OK && !(glewStatus == GLEW_ERROR_NO_GLX_DISPLAY && glCreateProgram)) {
+		std::cout << "Error.  GLEW init() not ok." << std::endl;
+		glfwMakeContextCurrent(NULL);
+		glfwDestroyWindow(window);
+		return nullptr;
+	}
+	return window;
+}
@@ -1,11 +1,69 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <cstdint>
+#include "FrameArena.h"
 
 #define A_LENGTH(a) (sizeof(a) / sizeof(*a))
+#ifdef _MSC_VER
 #define ASSERT(x) if (!(x)) __debugbreak();
+#else
+#define ASSERT(x) if (!(x)) __builtin_trap();
+#endif
 #define GlCall(x) GlClearError();\
 	x;\
 	ASSERT(GlLogCall(#x, __FILE__, __LINE__))
 void GlClearError(); 
-bool GlLogCall(const char* function, const char* file, int line);
\ No newline at end of file
+bool GlLogCall(const char* function, const char* file, int line);
+
+/* counters bumped by the draw and upload wrappers; reset at the start of every frame.  Per thread, so each App counts its own draws. */
+struct RenderStats
+{
+	unsigned int DrawCalls;
+	unsigned long long Vertices;
+	unsigned int Uploads;
+	unsigned long long UploadBytes;
+};
+extern thread_local RenderStats g_RenderStats;
+
+inline void CountDraw(unsigned long long vertices)
+{
+	g_RenderStats.DrawCalls++;
+	g_RenderStats.Vertices += vertices;
+}
+
+inline void CountUpload(unsigned long long bytes)
+{
+	g_RenderStats.Uploads++;
+	g_RenderStats.UploadBytes += bytes;
+}
+
+class VertexBuffer;
+class IndexBuffer;
+
+/* one draw recorded by SceneStore::Record(), in entity order, which is also the order they overlap in */
+struct DrawCommand
+{
+	const VertexBuffer* Vertices;
+	const IndexBuffer* Indices;
+	unsigned int Mode;
+	unsigned int Components;       // floats per vertex
+	unsigned int Object;           // ObjectParams index, passed as the base instance
+	unsigned int First;            // range of the index buffer to draw
+	unsigned int Count;
+};
+typedef ArenaVector<DrawCommand> CommandList;
+
+/* submits the list in order, binding buffers only where they change between commands */
+void Submit(const CommandList& commands);
+
+struct GLFWwindow;
+
+/* false without an X11 or Wayland display; the offscreen modes then use GLFW's null platform */
+bool HasDisplay();
+/*
+ * Main thread: a window with an OpenGL 4.6 core context, current on this thread
+ * and with GLEW loaded, or nullptr.  On GLFW's null platform the context comes
+ * from EGL, with OSMesa as the fallback.
+ */
+GLFWwindow* CreateGlWindow(int width, int height, bool visible);
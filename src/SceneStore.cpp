@@ -0,0 +1,180 @@
+#include "SceneStore.h"
+#include "IndexBuffer.h"
+#include "JobSystem.h"
+#include "ParameterBuffer.h"
+#include "Profiler.h"
+#include "VertexBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+
+SceneStore::SceneStore(unsigned int capacity)
+	: m_Capacity(capacity), m_Count(0),
+	m_MinX(capacity), m_MinY(capacity), m_MaxX(capacity), m_MaxY(capacity), m_Colors(capacity),
+	m_Flags(capacity), m_Kinds(capacity), m_FirstIndex(capacity), m_IndexCount(capacity), m_MaxVertices(capacity)
+{
+}
+
+SceneStore::~SceneStore()
+{
+}
+
+unsigned int SceneStore::Add(Kind kind, const float* positions, unsigned int vertexCount, unsigned int components, const ObjectParams& color)
+{
+	ASSERT(m_Count < m_Capacity && !m_VertexBuffer && vertexCount > 0);
+	ASSERT(components == 2 || components == 3);
+	unsigned int entity = m_Count++;
+	unsigned int firstVertex = (unsigned int)(m_Vertices.size() / COMPONENTS);
+
+	float minX = positions[0], maxX = positions[0];
+	float minY = positions[1], maxY = positions[1];
+	for (unsigned int v = 0; v < vertexCount; v++) {
+		const float* p = positions + v * components;
+		minX = std::min(minX, p[0]);
+		maxX = std::max(maxX, p[0]);
+		minY = std::min(minY, p[1]);
+		maxY = std::max(maxY, p[1]);
+		m_Vertices.push_back(p[0]);
+		m_Vertices.push_back(p[1]);
+		m_Vertices.push_back(components == 3 ? p[2] : 0.0f);
+	}
+
+	m_FirstIndex[entity] = (unsigned int)m_Indices.size();
+	m_IndexCount[entity] = vertexCount;
+	m_MaxVertices[entity] = vertexCount;
+	for (unsigned int v = 0; v < vertexCount; v++)
+		m_Indices.push_back(firstVertex + v);
+
+	m_MinX[entity] = minX;
+	m_MinY[entity] = minY;
+	m_MaxX[entity] = maxX;
+	m_MaxY[entity] = maxY;
+	m_Colors[entity] = color;
+	m_Flags[entity] = FLAG_ENABLED;
+	m_Kinds[entity] = kind;
+	return entity;
+}
+
+unsigned int SceneStore::Reserve(Kind kind, unsigned int maxVertices, const ObjectParams& color)
+{
+	ASSERT(m_Count < m_Capacity && !m_VertexBuffer && maxVertices > 0);
+	unsigned int entity = m_Count++;
+	unsigned int firstVertex = (unsigned int)(m_Vertices.size() / COMPONENTS);
+	m_Vertices.resize(m_Vertices.size() + maxVertices * COMPONENTS, 0.0f);
+
+	m_FirstIndex[entity] = (unsigned int)m_Indices.size();
+	m_IndexCount[entity] = 0;
+	m_MaxVertices[entity] = maxVertices;
+	for (unsigned int v = 0; v < maxVertices; v++)
+		m_Indices.push_back(firstVertex + v);
+
+	/* empty bounds overlap nothing, so Cull() never marks it visible */
+	m_MinX[entity] = FLT_MAX;
+	m_MinY[entity] = FLT_MAX;
+	m_MaxX[entity] = -FLT_MAX;
+	m_MaxY[entity] = -FLT_MAX;
+	m_Colors[entity] = color;
+	m_Flags[entity] = FLAG_ENABLED;
+	m_Kinds[entity] = kind;
+	return entity;
+}
+
+void SceneStore::SetGeometry(unsigned int entity, const float* positions, unsigned int vertexCount, unsigned int components)
+{
+	ASSERT(m_VertexBuffer && entity < m_Count && vertexCount <= m_MaxVertices[entity]);
+	ASSERT(components == 2 || components == 3);
+	const unsigned int CHUNK = 64;  // vertices widened to COMPONENTS per buffer write
+	float chunk[CHUNK * COMPONENTS];
+
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (unsigned int first = 0; first < vertexCount; first += CHUNK) {
+		unsigned int count = std::min(CHUNK, vertexCount - first);
+		for (unsigned int v = 0; v < count; v++) {
+			const float* p = positions + (first + v) * components;
+			minX = std::min(minX, p[0]);
+			maxX = std::max(maxX, p[0]);
+			minY = std::min(minY, p[1]);
+			maxY = std::max(maxY, p[1]);
+			chunk[v * COMPONENTS] = p[0];
+			chunk[v * COMPONENTS + 1] = p[1];
+			chunk[v * COMPONENTS + 2] = components == 3 ? p[2] : 0.0f;
+		}
+		m_VertexBuffer->Update((m_FirstIndex[entity] + first) * COMPONENTS, chunk, count * COMPONENTS);
+	}
+
+	m_IndexCount[entity] = vertexCount;
+	m_MinX[entity] = minX;
+	m_MinY[entity] = minY;
+	m_MaxX[entity] = maxX;
+	m_MaxY[entity] = maxY;
+}
+
+void SceneStore::Upload()
+{
+	PROFILE_FUNCTION();
+	m_VertexBuffer = std::make_unique<VertexBuffer>(m_Vertices.data(), (int)m_Vertices.size());
+	m_IndexBuffer = std::make_unique<IndexBuffer>(m_Indices.data(), (unsigned int)m_Indices.size());
+	std::vector<float>().swap(m_Vertices);
+	std::vector<unsigned int>().swap(m_Indices);
+}
+
+void SceneStore::WriteParams(ParameterBuffer& params) const
+{
+	ASSERT(m_Count <= params.MaxObjects());
+	for (unsigned int i = 0; i < m_Count; i++)
+		params.SetObject(i, m_Colors[i]);
+}
+
+void SceneStore::SetEnabled(unsigned int entity, bool enabled)
+{
+	if (enabled)
+		m_Flags[entity] |= FLAG_ENABLED;
+	else
+		m_Flags[entity] &= ~FLAG_ENABLED;
+}
+
+/* Branch-free, so the compiler can vectorize it.  Everything is a parameter because the byte
+   stores to flags could otherwise alias the bounds and the count, forcing a reload per entity. */
+static unsigned int cullRange(const float* minX, const float* minY, const float* maxX, const float* maxY, uint8_t* flags,
+	unsigned int begin, unsigned int end, float left, float bottom, float right, float top)
+{
+	unsigned int visible = 0;
+	for (unsigned int i = begin; i < end; i++) {
+		uint8_t overlap = (uint8_t)((minX[i] <= right) & (maxX[i] >= left) & (minY[i] <= top) & (maxY[i] >= bottom));
+		uint8_t show = (uint8_t)(flags[i] & SceneStore::FLAG_ENABLED & overlap);
+		flags[i] = (uint8_t)((flags[i] & ~SceneStore::FLAG_VISIBLE) | (show << 1));
+		visible += show;
+	}
+	return visible;
+}
+
+unsigned int SceneStore::Cull(float minX, float minY, float maxX, float maxY, JobSystem* jobs)
+{
+	PROFILE_FUNCTION();
+	const float* entityMinX = m_MinX.Data();
+	const float* entityMinY = m_MinY.Data();
+	const float* entityMaxX = m_MaxX.Data();
+	const float* entityMaxY = m_MaxY.Data();
+	uint8_t* flags = m_Flags.Data();
+
+	if (!jobs || m_Count <= CULL_GRAIN)
+		return cullRange(entityMinX, entityMinY, entityMaxX, entityMaxY, flags, 0, m_Count, minX, minY, maxX, maxY);
+
+	std::atomic<unsigned int> visible(0);
+	jobs->ParallelFor(m_Count, CULL_GRAIN, [&](unsigned int begin, unsigned int end) {
+		unsigned int count = cullRange(entityMinX, entityMinY, entityMaxX, entityMaxY, flags, begin, end, minX, minY, maxX, maxY);
+		visible.fetch_add(count, std::memory_order_relaxed);
+	});
+	return visible.load(std::memory_order_relaxed);
+}
+
+void SceneStore::Record(CommandList& commands, Kind kind, unsigned int mode) const
+{
+	PROFILE_FUNCTION();
+	ASSERT(m_VertexBuffer);
+	for (unsigned int i = 0; i < m_Count; i++) {
+		if ((m_Flags[i] & FLAG_VISIBLE) && m_Kinds[i] == kind)
+			commands.push_back({ m_VertexBuffer.get(), m_IndexBuffer.get(), mode, COMPONENTS, i, m_FirstIndex[i], m_IndexCount[i] });
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "Renderer.h"
+#include "ShaderParams.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+class VertexBuffer;
+class IndexBuffer;
+class ParameterBuffer;
+class JobSystem;
+
+/*
+ * Data-oriented scene storage.  An entity is an index into parallel arrays
+ * (bounds, colors, flags, kinds, index ranges), each contiguous and 64-byte
+ * aligned, so the per-frame passes stream through just the fields they read:
+ * Cull() only touches bounds and flags, Record() only flags, kinds and ranges.
+ * The vertices of all entities share one vertex and one index buffer, and an
+ * entity's ObjectParams slot is its ID.  Reserve() sets aside room for an
+ * entity whose vertices change after Upload(); SetGeometry() rewrites them in place.
+ */
+class SceneStore
+{
+public:
+	enum Kind : uint8_t
+	{
+		KIND_POINTS,
+		KIND_LINES,
+		KIND_TRIANGLES
+	};
+
+	enum Flag : uint8_t
+	{
+		FLAG_ENABLED = 1,
+		FLAG_VISIBLE = 2   // written by Cull()
+	};
+
+	static const unsigned int COMPONENTS = 3;  // floats per vertex; 2-D positions get z = 0
+	static const size_t ALIGNMENT = 64;
+	static const unsigned int CULL_GRAIN = 16384;  // entities per culling job
+private:
+	/* fixed-capacity array on a cache line boundary */
+	template<typename T>
+	class Array
+	{
+	private:
+		T* m_Data;
+	public:
+		explicit Array(size_t capacity)
+			: m_Data(static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(ALIGNMENT)))) {}
+		~Array() { ::operator delete(m_Data, std::align_val_t(ALIGNMENT)); }
+		Array(const Array&) = delete;
+		Array& operator=(const Array&) = delete;
+
+		T& operator[](size_t i) { return m_Data[i]; }
+		const T& operator[](size_t i) const { return m_Data[i]; }
+		T* Data() { return m_Data; }
+		const T* Data() const { return m_Data; }
+	};
+
+	unsigned int m_Capacity;
+	unsigned int m_Count;
+	Array<float> m_MinX;
+	Array<float> m_MinY;
+	Array<float> m_MaxX;
+	Array<float> m_MaxY;
+	Array<ObjectParams> m_Colors;
+	Array<uint8_t> m_Flags;
+	Array<uint8_t> m_Kinds;
+	Array<unsigned int> m_FirstIndex;   // also the first vertex: every entity indexes its own vertices in order
+	Array<unsigned int> m_IndexCount;
+	Array<unsigned int> m_MaxVertices;
+
+	/* staging until Upload() */
+	std::vector<float> m_Vertices;
+	std::vector<unsigned int> m_Indices;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+public:
+	explicit SceneStore(unsigned int capacity);
+	~SceneStore();
+
+	/* returns the entity ID; positions has `components` (2 or 3) floats per vertex */
+	unsigned int Add(Kind kind, const float* positions, unsigned int vertexCount, unsigned int components, const ObjectParams& color);
+	/* returns the ID of an entity with room for maxVertices and no geometry yet; it is never visible until SetGeometry() */
+	unsigned int Reserve(Kind kind, unsigned int maxVertices, const ObjectParams& color);
+	/* creates the shared GPU buffers; no entity can be added afterwards */
+	void Upload();
+	void WriteParams(ParameterBuffer& params) const;
+
+	unsigned int Count() const { return m_Count; }
+	void SetEnabled(unsigned int entity, bool enabled);
+	/* after Upload(): replaces the vertices of a reserved entity and writes them to the vertex buffer */
+	void SetGeometry(unsigned int entity, const float* positions, unsigned int vertexCount, unsigned int components);
+	/* the caller writes the color to the ParameterBuffer as well */
+	void SetColor(unsigned int entity, const ObjectParams& color) { m_Colors[entity] = color; }
+
+	/* visibility pass: marks the enabled entities whose bounds overlap the rectangle, returns how many;
+	   with jobs, ranges of CULL_GRAIN entities are culled in parallel */
+	unsigned int Cull(float minX, float minY, float maxX, float maxY, JobSystem* jobs = nullptr);
+	/* batch pass: a draw command per visible entity of the kind, drawn with the given primitive mode */
+	void Record(CommandList& commands, Kind kind, unsigned int mode) const;
+};
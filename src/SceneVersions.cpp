@@ -0,0 +1,187 @@
+#include "SceneVersions.h"
+#include "Renderer.h"
+#include "SceneStore.h"
+#include "ParameterBuffer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+SceneVersions::SceneVersions(unsigned int count, const ObjectParams& color)
+	: m_Count(count), m_Current(nullptr), m_Published(0), m_LastVersion(0), m_LastChunkVersion(0), m_Reclaimed(0)
+{
+	for (Hazard& hazard : m_Hazards) {
+		hazard.Pointer.store(nullptr, std::memory_order_relaxed);
+		hazard.Taken.store(false, std::memory_order_relaxed);
+	}
+
+	unsigned int chunks = (count + CHUNK_ENTITIES - 1) / CHUNK_ENTITIES;
+	m_Draft.resize(chunks);
+	m_Copied.assign(chunks, true);
+	for (Chunk*& chunk : m_Draft) {
+		chunk = new Chunk();
+		chunk->Version = ++m_LastChunkVersion;
+		chunk->Shares = 0;
+		for (Entity& entity : chunk->Entities) {
+			entity.VertexCount = 0;
+			entity.Enabled = true;
+			entity.Color = color;
+		}
+	}
+	Publish();
+}
+
+SceneVersions::~SceneVersions()
+{
+	/* the readers are gone, so every version can go */
+	for (Snapshot* snapshot : m_Retired)
+		Free(snapshot);
+	Free(m_Current.load(std::memory_order_relaxed));
+
+	/* chunks copied since the last Publish() belong to no version */
+	for (size_t i = 0; i < m_Draft.size(); i++)
+		if (m_Copied[i])
+			delete m_Draft[i];
+}
+
+SceneVersions::Entity& SceneVersions::Edit(unsigned int entity)
+{
+	ASSERT(entity < m_Count);
+	unsigned int index = entity / CHUNK_ENTITIES;
+	if (!m_Copied[index]) {
+		/* copy on first write; the published version keeps the original */
+		Chunk* copy = new Chunk(*m_Draft[index]);
+		copy->Version = ++m_LastChunkVersion;
+		copy->Shares = 0;
+		m_Draft[index] = copy;
+		m_Copied[index] = true;
+	}
+	return m_Draft[index]->Entities[entity % CHUNK_ENTITIES];
+}
+
+void SceneVersions::SetGeometry(unsigned int entity, const float* positions, unsigned int vertexCount)
+{
+	ASSERT(vertexCount <= MAX_VERTICES);
+	Entity& target = Edit(entity);
+	target.VertexCount = vertexCount;
+	memcpy(target.Positions, positions, vertexCount * 2 * sizeof(float));
+}
+
+void SceneVersions::SetColor(unsigned int entity, const ObjectParams& color)
+{
+	Edit(entity).Color = color;
+}
+
+void SceneVersions::SetEnabled(unsigned int entity, bool enabled)
+{
+	Edit(entity).Enabled = enabled;
+}
+
+void SceneVersions::Publish()
+{
+	PROFILE_FUNCTION();
+	Snapshot* snapshot = new Snapshot();
+	snapshot->Version = ++m_LastVersion;
+	snapshot->Chunks = m_Draft;
+	for (Chunk* chunk : m_Draft)
+		chunk->Shares++;
+	std::fill(m_Copied.begin(), m_Copied.end(), false);
+
+	/* seq_cst, so a reader that checks m_Current after setting its hazard cannot miss the swap */
+	Snapshot* old = m_Current.exchange(snapshot, std::memory_order_seq_cst);
+	m_Published.store(snapshot->Version, std::memory_order_release);
+	if (old)
+		m_Retired.push_back(old);
+	Reclaim();
+}
+
+void SceneVersions::Reclaim()
+{
+	const Snapshot* held[MAX_READERS];
+	for (int i = 0; i < MAX_READERS; i++)
+		held[i] = m_Hazards[i].Pointer.load(std::memory_order_seq_cst);
+
+	size_t kept = 0;
+	for (Snapshot* snapshot : m_Retired) {
+		if (std::find(held, held + MAX_READERS, snapshot) != held + MAX_READERS)
+			m_Retired[kept++] = snapshot;
+		else {
+			Free(snapshot);
+			m_Reclaimed++;
+		}
+	}
+	m_Retired.resize(kept);
+}
+
+void SceneVersions::Free(Snapshot* snapshot)
+{
+	for (Chunk* chunk : snapshot->Chunks) {
+		if (--chunk->Shares == 0)
+			delete chunk;
+	}
+	delete snapshot;
+}
+
+SceneVersions::Reader::Reader(SceneVersions& versions)
+	: m_Versions(versions), m_Slot(-1)
+{
+	for (int i = 0; i < MAX_READERS && m_Slot < 0; i++) {
+		bool free = false;
+		if (versions.m_Hazards[i].Taken.compare_exchange_strong(free, true))
+			m_Slot = i;
+	}
+	ASSERT(m_Slot >= 0);
+	m_Applied.assign((versions.m_Count + CHUNK_ENTITIES - 1) / CHUNK_ENTITIES, 0);
+}
+
+SceneVersions::Reader::~Reader()
+{
+	Release();
+	m_Versions.m_Hazards[m_Slot].Taken.store(false, std::memory_order_release);
+}
+
+const SceneVersions::Snapshot& SceneVersions::Reader::Acquire()
+{
+	/* the hazard only counts once it is visible before the writer's next look at m_Current */
+	std::atomic<const Snapshot*>& hazard = m_Versions.m_Hazards[m_Slot].Pointer;
+	const Snapshot* snapshot = m_Versions.m_Current.load(std::memory_order_seq_cst);
+	for (;;) {
+		hazard.store(snapshot, std::memory_order_seq_cst);
+		const Snapshot* current = m_Versions.m_Current.load(std::memory_order_seq_cst);
+		if (current == snapshot)
+			return *snapshot;
+		snapshot = current;
+	}
+}
+
+void SceneVersions::Reader::Release()
+{
+	m_Versions.m_Hazards[m_Slot].Pointer.store(nullptr, std::memory_order_release);
+}
+
+unsigned int SceneVersions::Reader::Apply(const Snapshot& snapshot, SceneStore& scene, ParameterBuffer& params, unsigned int firstEntity)
+{
+	PROFILE_FUNCTION();
+	unsigned int applied = 0;
+	for (size_t c = 0; c < snapshot.Chunks.size(); c++) {
+		const Chunk& chunk = *snapshot.Chunks[c];
+		if (chunk.Version == m_Applied[c])
+			continue;
+		m_Applied[c] = chunk.Version;
+
+		unsigned int first = (unsigned int)c * CHUNK_ENTITIES;
+		/* not std::min: it takes CHUNK_ENTITIES by reference, which needs a definition the header does not give */
+		unsigned int remaining = m_Versions.m_Count - first;
+		unsigned int count = remaining < CHUNK_ENTITIES ? remaining : CHUNK_ENTITIES;
+		for (unsigned int i = 0; i < count; i++) {
+			const Entity& entity = chunk.Entities[i];
+			unsigned int id = firstEntity + first + i;
+			scene.SetGeometry(id, entity.Positions, entity.VertexCount, 2);
+			scene.SetColor(id, entity.Color);
+			scene.SetEnabled(id, entity.Enabled);
+			params.SetObject(id, entity.Color);
+		}
+		applied++;
+	}
+	return applied;
+}
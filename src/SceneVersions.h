@@ -0,0 +1,113 @@
+#pragma once
+#include "ShaderParams.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class SceneStore;
+class ParameterBuffer;
+
+/*
+ * Editable entities published as immutable versions, read-copy-update style.
+ * One writer thread edits a draft; the first edit to a chunk of CHUNK_ENTITIES
+ * entities copies that chunk, the rest stay shared with the published version.
+ * Publish() swaps the draft in with one atomic pointer exchange, so a reader
+ * sees either all of an edit or none of it, and neither side takes a lock.
+ *
+ * Readers announce the version they use in a hazard pointer.  The writer keeps
+ * the versions it replaced until no hazard points at them, then frees them
+ * along with the chunks no remaining version shares.
+ */
+class SceneVersions
+{
+public:
+	static const unsigned int CHUNK_ENTITIES = 16;
+	static const unsigned int MAX_VERTICES = 32;   // 2-D positions per entity
+	static const int MAX_READERS = 4;
+
+	struct Entity
+	{
+		unsigned int VertexCount;
+		bool Enabled;
+		ObjectParams Color;
+		float Positions[MAX_VERTICES * 2];
+	};
+
+	struct Chunk
+	{
+		uint64_t Version;        // unique per copy; a reader re-applies the chunk when it changes
+		unsigned int Shares;     // published versions holding the chunk; touched by the writer only
+		Entity Entities[CHUNK_ENTITIES];
+	};
+
+	struct Snapshot
+	{
+		uint64_t Version;
+		std::vector<Chunk*> Chunks;
+	};
+
+	/* The renderer's side.  Acquire() at frame start, Release() once the frame is done with it. */
+	class Reader
+	{
+	private:
+		SceneVersions& m_Versions;
+		int m_Slot;
+		std::vector<uint64_t> m_Applied;   // chunk versions already in the scene store
+	public:
+		explicit Reader(SceneVersions& versions);
+		~Reader();
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+		/* the newest version; it stays alive until Release() */
+		const Snapshot& Acquire();
+		void Release();
+		/* copies the chunks that changed since the last Apply() into the scene, entity i going to firstEntity + i */
+		unsigned int Apply(const Snapshot& snapshot, SceneStore& scene, ParameterBuffer& params, unsigned int firstEntity);
+	};
+private:
+	struct alignas(64) Hazard
+	{
+		std::atomic<const Snapshot*> Pointer;
+		std::atomic<bool> Taken;
+	};
+
+	unsigned int m_Count;
+	std::atomic<Snapshot*> m_Current;
+	std::atomic<uint64_t> m_Published;
+	Hazard m_Hazards[MAX_READERS];
+
+	/* writer only */
+	std::vector<Chunk*> m_Draft;
+	std::vector<bool> m_Copied;   // draft chunks not published yet
+	std::vector<Snapshot*> m_Retired;
+	uint64_t m_LastVersion;
+	uint64_t m_LastChunkVersion;
+	uint64_t m_Reclaimed;
+public:
+	/* publishes version 1: count enabled entities without vertices */
+	SceneVersions(unsigned int count, const ObjectParams& color);
+	~SceneVersions();
+	SceneVersions(const SceneVersions&) = delete;
+	SceneVersions& operator=(const SceneVersions&) = delete;
+
+	unsigned int Count() const { return m_Count; }
+	/* any thread: the newest version number, to notice edits without acquiring them */
+	uint64_t Published() const { return m_Published.load(std::memory_order_acquire); }
+
+	/* writer: edits to the draft; nothing is visible to readers before Publish() */
+	void SetGeometry(unsigned int entity, const float* positions, unsigned int vertexCount);
+	void SetColor(unsigned int entity, const ObjectParams& color);
+	void SetEnabled(unsigned int entity, bool enabled);
+	/* writer: makes the draft the current version and frees the old versions no reader holds */
+	void Publish();
+
+	/* writer: versions replaced but held by a reader at the last Publish() */
+	size_t Retired() const { return m_Retired.size(); }
+	uint64_t Reclaimed() const { return m_Reclaimed; }
+private:
+	Entity& Edit(unsigned int entity);
+	void Reclaim();
+	void Free(Snapshot* snapshot);
+};
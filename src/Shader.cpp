@@ -1,16 +1,29 @@
 #include "Shader.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <alloca.h>
+#endif
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 
 Shader::Shader(const std::string& filepath)
 	: m_FilePath(filepath), m_RenderID(0)
 {
-	ShaderProgramSource source = ParseShader();
+	ShaderProgramSource source = ParseShader(m_FilePath);
+	if (!source.Complete)
+		return;  // already reported; m_RenderID stays 0
 	m_RenderID = CreateShader(source.VertexSource, source.FragmentSource);
+	Reflect();
+}
+
+Shader::Shader(const std::string& filepath, unsigned int programID)
+	: m_FilePath(filepath), m_RenderID(programID)
+{
+	Reflect();
 }
 
 Shader::~Shader()
@@ -28,64 +41,217 @@ void Shader::Unbind() const
 	GlCall(glUseProgram(0));
 }
 
+static const char* typeName(unsigned int type)
+{
+	switch (type) {
+		case GL_FLOAT:        return "float";
+		case GL_FLOAT_VEC2:   return "vec2";
+		case GL_FLOAT_VEC3:   return "vec3";
+		case GL_FLOAT_VEC4:   return "vec4";
+		case GL_INT:          return "int";
+		case GL_UNSIGNED_INT: return "uint";
+		case GL_FLOAT_MAT4:   return "mat4";
+		case GL_SAMPLER_2D:   return "sampler2D";
+		default:              return "other";
+	}
+}
+
+UniformHandle Shader::GetUniform(const std::string& name, unsigned int expectedType) const
+{
+	for (size_t i = 0; i < m_Uniforms.size(); i++)
+	{
+		const ShaderUniform& uniform = m_Uniforms[i];
+		if (uniform.Name != name)
+			continue;
+
+		if (uniform.Type != expectedType)
+		{
+			std::cout << "Error:  uniform '" << name << "' in " << m_FilePath << " is a " << typeName(uniform.Type)
+				<< ", not a " << typeName(expectedType) << "!" << std::endl;
+			return -1;
+		}
+		return (UniformHandle)i;
+	}
+
+	std::cout << "Warning:  uniform '" << name << "' doesn't exist!" << std::endl;
+	return -1;
+}
+
+void Shader::SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3)
+{
+	if (uniform < 0)
+		return;
+
+	GlCall(glProgramUniform4f(m_RenderID, m_Uniforms[uniform].Location, v0, v1, v2, v3));
+}
+
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-	GlCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+	SetUniform4f(GetUniform(name, GL_FLOAT_VEC4), v0, v1, v2, v3);
 }
 
-unsigned int Shader::GetUniformLocation(const std::string& name)
+const ShaderBlock* Shader::GetBlock(const std::string& name) const
 {
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end()) 
-		return m_UniformLocationCache[name];
+	for (const ShaderBlock& block : m_Blocks)
+		if (block.Name == name)
+			return &block;
+	return nullptr;
+}
+
+/*
+ * Build the uniform and block tables right after linking, so nothing has to be
+ * queried from the driver on the first frame that uses the shader.
+ */
+void Shader::Reflect()
+{
+	PROFILE_FUNCTION();
+	int count = 0;
+	GlCall(glGetProgramInterfaceiv(m_RenderID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count));
+	m_Uniforms.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		const GLenum props[] = { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX };
+		int values[A_LENGTH(props)];
+		GlCall(glGetProgramResourceiv(m_RenderID, GL_UNIFORM, i, A_LENGTH(props), props, A_LENGTH(values), nullptr, values));
+
+		ShaderUniform uniform;
+		uniform.Name.resize(values[0]);
+		GlCall(glGetProgramResourceName(m_RenderID, GL_UNIFORM, i, values[0], nullptr, &uniform.Name[0]));
+		uniform.Name.resize(values[0] - 1); // drop the terminating null
+		if (uniform.Name.size() > 3 && uniform.Name.compare(uniform.Name.size() - 3, 3, "[0]") == 0)
+			uniform.Name.resize(uniform.Name.size() - 3);
+		uniform.Type = values[1];
+		uniform.Location = values[2];
+		uniform.ArraySize = values[3];
+		uniform.BlockIndex = values[4];
+		m_Uniforms.push_back(uniform);
+	}
+
+	ReflectBlocks(GL_UNIFORM_BLOCK);
+	ReflectBlocks(GL_SHADER_STORAGE_BLOCK);
+}
 
-	GlCall(unsigned int location = glGetUniformLocation(m_RenderID, name.c_str()));
-	if (location == -1)
-		std::cout << "Warning:  uniform '" << name << "' doesn't exist!" << std::endl;
+void Shader::ReflectBlocks(unsigned int blockInterface)
+{
+	int count = 0;
+	GlCall(glGetProgramInterfaceiv(m_RenderID, blockInterface, GL_ACTIVE_RESOURCES, &count));
+	for (int i = 0; i < count; i++)
+	{
+		const GLenum props[] = { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+		int values[A_LENGTH(props)];
+		GlCall(glGetProgramResourceiv(m_RenderID, blockInterface, i, A_LENGTH(props), props, A_LENGTH(values), nullptr, values));
 
-	m_UniformLocationCache[name] = location;
-	
-	return location;
+		ShaderBlock block;
+		block.Name.resize(values[0]);
+		GlCall(glGetProgramResourceName(m_RenderID, blockInterface, i, values[0], nullptr, &block.Name[0]));
+		block.Name.resize(values[0] - 1);
+		block.Interface = blockInterface;
+		block.Binding = values[1];
+		block.DataSize = values[2];
+		m_Blocks.push_back(block);
+	}
 }
 
-ShaderProgramSource Shader::ParseShader() {
+ShaderProgramSource Shader::ParseShader(const std::string& filepath, const ShaderDefines& defines) {
+	PROFILE_FUNCTION();
 	enum class ShaderType
 	{
 		NONE = -1, VERTEX = 0, FRAGMENT = 1
 	};
 
-	std::ifstream stream(m_FilePath); // open file
-	std::string line;
-	std::stringstream ss[2];
+	ShaderProgramSource source;
+	const MappedFile* file = source.Storage.Map(filepath);
+	if (!file)
+	{
+		std::cout << "Failed to open shader '" << filepath << "'!" << std::endl;
+		source.Complete = false;
+		return source;
+	}
+
+	/* each stage is the range of lines between its #shader line and the next one */
+	std::string_view text = file->View();
+	std::string_view stages[2];
 	ShaderType type = ShaderType::NONE;
-	while (getline(stream, line))
+	size_t stageStart = 0;
+	for (size_t directive = text.find("#shader"); directive != std::string_view::npos; directive = text.find("#shader", stageStart))
 	{
-		if (line.find("#shader") != std::string::npos)
-		{
-			if (line.find("vertex") != std::string::npos)
-				type = ShaderType::VERTEX;
-			else if (line.find("fragment") != std::string::npos)
-				type = ShaderType::FRAGMENT;
-		}
+		size_t lineStart = text.rfind('\n', directive);
+		lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+		size_t lineEnd = text.find('\n', directive);
+		lineEnd = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+		std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+
+		if (type != ShaderType::NONE)
+			stages[(int)type] = text.substr(stageStart, lineStart - stageStart);
+
+		if (line.find("vertex") != std::string_view::npos)
+			type = ShaderType::VERTEX;
+		else if (line.find("fragment") != std::string_view::npos)
+			type = ShaderType::FRAGMENT;
 		else
-		{
-			ss[(int)type] << line << '\n';
-		}
+			type = ShaderType::NONE;
+		stageStart = lineEnd;
 	}
+	if (type != ShaderType::NONE)
+		stages[(int)type] = text.substr(stageStart);
 
-	std::cout << "VERTEX" << std::endl;
-	std::cout << ss[0].str() << std::endl;
-	std::cout << "FRAGMENT" << std::endl;
-	std::cout << ss[1].str() << std::endl;
+	/* a missing section stays empty, which is how single-stage (separable) files are recognized */
+	if (!stages[0].empty())
+		source.Complete = ShaderPreprocessor::Process(stages[0], filepath, defines, source.Storage, source.VertexSource);
+	if (!stages[1].empty())
+		source.Complete = ShaderPreprocessor::Process(stages[1], filepath, defines, source.Storage, source.FragmentSource) && source.Complete;
+	return source;
+}
+
+unsigned int Shader::CompileShader(unsigned int type, const ShaderSourcePieces& source) {
+	PROFILE_FUNCTION();
+	unsigned int id = glCreateShader(type);
+
+	/* GL concatenates the pieces itself, so they are passed straight from the mapped file */
+	const char** strings = (const char**)alloca(source.size() * sizeof(const char*));
+	int* lengths = (int*)alloca(source.size() * sizeof(int));
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		strings[i] = source[i].data();
+		lengths[i] = (int)source[i].size();
+	}
+	GlCall(glShaderSource(id, (GLsizei)source.size(), strings, lengths));
+	GlCall(glCompileShader(id)); // only queues the work; the status is checked in CheckCompileStatus()
 
-	return { ss[0].str(), ss[1].str() };
+	return id;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source) {
+unsigned int Shader::CompileSpirv(unsigned int type, const std::string& modulePath, const SpecializationConstants& constants) {
+	PROFILE_FUNCTION();
+	if (!GLEW_VERSION_4_6 && !GLEW_ARB_gl_spirv)
+	{
+		std::cout << "Failed to load " << modulePath << ": SPIR-V needs OpenGL 4.6 or ARB_gl_spirv!" << std::endl;
+		return 0;
+	}
+
+	MappedFile module(modulePath);
+	if (!module.IsOpen() || module.View().empty())
+	{
+		std::cout << "Failed to open SPIR-V module '" << modulePath << "'!" << std::endl;
+		return 0;
+	}
+
 	unsigned int id = glCreateShader(type);
-	const char* src = source.c_str();
-	GlCall(glShaderSource(id, 1, &src, nullptr)); // set the source code in the shader to the 1 string
-	GlCall(glCompileShader(id));
+	GlCall(glShaderBinary(1, &id, GL_SHADER_BINARY_FORMAT_SPIR_V, module.View().data(), (GLsizei)module.View().size()));
+
+	unsigned int* indices = (unsigned int*)alloca(constants.size() * sizeof(unsigned int));
+	unsigned int* values = (unsigned int*)alloca(constants.size() * sizeof(unsigned int));
+	for (size_t i = 0; i < constants.size(); i++)
+	{
+		indices[i] = constants[i].first;
+		values[i] = constants[i].second;
+	}
+	GlCall(glSpecializeShader(id, "main", (GLuint)constants.size(), indices, values)); // status is checked in CheckCompileStatus()
+
+	return id;
+}
 
+bool Shader::CheckCompileStatus(unsigned int id, unsigned int type) {
 	int result;
 	GlCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
 	if (result == GL_FALSE)
@@ -96,15 +262,55 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 		GlCall(glGetShaderInfoLog(id, length, &length, infoLog));
 		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
 		std::cout << infoLog << std::endl;
-		GlCall(glDeleteShader(id));
-		return 0;
+		LogShaderSource(id);
+		return false;
+	}
+
+	return true;
+}
 
+bool Shader::CheckLinkStatus(unsigned int program, const std::string& filepath) {
+	int result;
+	GlCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+	if (result == GL_FALSE)
+	{
+		int length;
+		GlCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+		char* infoLog = (char*)alloca(length * sizeof(char));
+		GlCall(glGetProgramInfoLog(program, length, &length, infoLog));
+		std::cout << "Failed to link program '" << filepath << "'!" << std::endl;
+		std::cout << infoLog << std::endl;
+		return false;
 	}
 
-	return id;
+	return true;
+}
+
+/* Sources are only printed when something is wrong with them, numbered so they match the info log. */
+void Shader::LogShaderSource(unsigned int id) {
+	int length;
+	GlCall(glGetShaderiv(id, GL_SHADER_SOURCE_LENGTH, &length));
+	if (length <= 0)
+		return;
+
+	std::string source(length, '\0');
+	GlCall(glGetShaderSource(id, length, &length, &source[0]));
+	source.resize(length);
+
+	int lineNumber = 1;
+	size_t lineStart = 0;
+	while (lineStart < source.size())
+	{
+		size_t lineEnd = source.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = source.size();
+		std::cout << lineNumber++ << ": " << source.substr(lineStart, lineEnd - lineStart) << std::endl;
+		lineStart = lineEnd + 1;
+	}
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader) {
+unsigned int Shader::CreateShader(const ShaderSourcePieces& vertexShader, const ShaderSourcePieces& fragmentShader) {
+	PROFILE_FUNCTION();
 	GlCall(unsigned int program = glCreateProgram());
 	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
 	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
@@ -113,7 +319,13 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 	GlCall(glAttachShader(program, vs));
 	GlCall(glAttachShader(program, fs));
 	GlCall(glLinkProgram(program));
-	GlCall(glValidateProgram(program));
+
+	bool ok = CheckCompileStatus(vs, GL_VERTEX_SHADER);
+	ok = CheckCompileStatus(fs, GL_FRAGMENT_SHADER) && ok;
+	ok = ok && CheckLinkStatus(program, m_FilePath);
+	if (ok) {
+		GlCall(glValidateProgram(program));
+	}
 
 	GlCall(glDeleteShader(vs));
 	GlCall(glDeleteShader(fs));
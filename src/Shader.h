@@ -1,31 +1,83 @@
 #pragma once
+#include "ShaderPreprocessor.h"
+
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 struct ShaderProgramSource
 {
-	std::string VertexSource;
-	std::string FragmentSource;
+	ShaderSourcePieces VertexSource;
+	ShaderSourcePieces FragmentSource;
+	ShaderSourceStorage Storage;  // the mapped shader file and its includes, which the pieces point into
+	bool Complete = true;         // false if the file could not be read or an #include could not be expanded
+};
+
+/* one active uniform of a linked program, as reported by program interface queries */
+struct ShaderUniform
+{
+	std::string Name;     // without a trailing "[0]" for arrays
+	unsigned int Type;    // GL_FLOAT_VEC4, GL_FLOAT_MAT4, ...
+	int Location;         // -1 for members of a uniform block
+	int ArraySize;
+	int BlockIndex;       // index into the uniform blocks, -1 for loose uniforms
+};
+
+/* an active uniform block (GL_UNIFORM_BLOCK) or storage block (GL_SHADER_STORAGE_BLOCK) */
+struct ShaderBlock
+{
+	std::string Name;
+	unsigned int Interface;
+	int Binding;
+	int DataSize;         // 0 for a storage block ending in an unsized array
 };
+
+/* SPIR-V specialization constants: constant_id -> value bits (floats via their bit pattern) */
+typedef std::vector<std::pair<unsigned int, unsigned int>> SpecializationConstants;
+
+/* returned by Shader::GetUniform(); an index into the shader's uniform table */
+typedef int UniformHandle;
  
 class Shader
 {
 private:
 	std::string m_FilePath;
 	unsigned int m_RenderID;
-	std::unordered_map<std::string, unsigned int> m_UniformLocationCache;
+	std::vector<ShaderUniform> m_Uniforms;
+	std::vector<ShaderBlock> m_Blocks;
 
 public:
 	Shader(const std::string& filepath);
+	/* takes ownership of a program that was already compiled and linked, e.g. by the ShaderLibrary */
+	Shader(const std::string& filepath, unsigned int programID);
 	~Shader();
 
 	void Bind() const;
 	void Unbind() const;
+	unsigned int GetRendererID() const { return m_RenderID; }
+
+	/* Resolve a uniform once at load time; a missing uniform or a type other than
+	   expectedType is reported here and yields -1, which the setters ignore. */
+	UniformHandle GetUniform(const std::string& name, unsigned int expectedType) const;
+	void SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+
+	const std::vector<ShaderUniform>& GetUniforms() const { return m_Uniforms; }
+	const std::vector<ShaderBlock>& GetBlocks() const { return m_Blocks; }
+	const ShaderBlock* GetBlock(const std::string& name) const;
+
+	/* The compile and link steps are split from their status checks so callers can put
+	   many programs in flight before blocking on any of them. */
+	static ShaderProgramSource ParseShader(const std::string& filepath, const ShaderDefines& defines = ShaderDefines());
+	static unsigned int CompileShader(unsigned int type, const ShaderSourcePieces& source);
+	/* loads a SPIR-V module and specializes its "main"; returns 0 if the module cannot be read */
+	static unsigned int CompileSpirv(unsigned int type, const std::string& modulePath, const SpecializationConstants& constants);
+	static bool CheckCompileStatus(unsigned int id, unsigned int type);
+	static bool CheckLinkStatus(unsigned int program, const std::string& filepath);
 private:
-	ShaderProgramSource ParseShader();
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int GetUniformLocation(const std::string& name);
+	static void LogShaderSource(unsigned int id);
+	unsigned int CreateShader(const ShaderSourcePieces& vertexShader, const ShaderSourcePieces& fragmentShader);
+	void Reflect();
+	void ReflectBlocks(unsigned int blockInterface);
 
-};
\ No newline at end of file
+};
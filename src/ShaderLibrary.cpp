@@ -0,0 +1,219 @@
+#include "ShaderLibrary.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include <iostream>
+#include <thread>
+
+ShaderLibrary::ShaderLibrary()
+{
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+}
+
+void ShaderLibrary::Add(const std::string& name, const std::string& filepath)
+{
+	ShaderFile& file = m_Files[name];
+	file.FilePath = filepath;
+	Request(name, ShaderDefines());
+}
+
+void ShaderLibrary::AddStage(const std::string& name, const std::string& filepath)
+{
+	ShaderFile& file = m_Files[name];
+	file.FilePath = filepath;
+	file.Separable = true;
+	Request(name, ShaderDefines());
+}
+
+void ShaderLibrary::AddSpirv(const std::string& name, const std::string& vertexModule, const std::string& fragmentModule,
+	const SpecializationConstants& vertexConstants, const SpecializationConstants& fragmentConstants)
+{
+	ShaderFile& file = m_Files[name];
+	file.FilePath = vertexModule;
+	file.Spirv = true;
+	file.FragmentModule = fragmentModule;
+	file.VertexConstants = vertexConstants;
+	file.FragmentConstants = fragmentConstants;
+	Request(name, ShaderDefines());
+}
+
+void ShaderLibrary::Request(const std::string& name, const ShaderDefines& defines)
+{
+	auto file = m_Files.find(name);
+	if (file == m_Files.end())
+	{
+		std::cout << "Warning:  shader '" << name << "' was never added!" << std::endl;
+		return;
+	}
+
+	if (file->second.Spirv && !defines.empty())
+	{
+		std::cout << "Warning:  SPIR-V shader '" << name << "' has no permutations, use specialization constants!" << std::endl;
+		return;
+	}
+
+	std::string key = ShaderPreprocessor::PermutationKey(name, defines);
+	if (m_Shaders.find(key) != m_Shaders.end() || m_Failed.find(key) != m_Failed.end())
+		return;
+	for (const PendingProgram& pending : m_Pending)
+		if (pending.Key == key)
+			return;
+
+	PendingProgram pending;
+	pending.Key = key;
+	pending.File = &file->second;
+	pending.Defines = defines;
+	m_Pending.push_back(pending);
+}
+
+void ShaderLibrary::Build()
+{
+	PROFILE_FUNCTION();
+	bool parallel = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+	if (GLEW_KHR_parallel_shader_compile) {
+		GlCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF)); // let the driver size its compile pool
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		GlCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+	}
+
+	/* queue every compile before the first link so none of them waits on another */
+	for (PendingProgram& pending : m_Pending)
+	{
+		if (pending.File->Spirv)
+		{
+			pending.VertexID = Shader::CompileSpirv(GL_VERTEX_SHADER, pending.File->FilePath, pending.File->VertexConstants);
+			pending.FragmentID = Shader::CompileSpirv(GL_FRAGMENT_SHADER, pending.File->FragmentModule, pending.File->FragmentConstants);
+			continue;
+		}
+
+		/* a stage file only has one of the two sections */
+		ShaderProgramSource source = Shader::ParseShader(pending.File->FilePath, pending.Defines);
+		pending.SourceComplete = source.Complete;
+		if (!source.Complete)
+			continue;
+		if (!source.VertexSource.empty())
+			pending.VertexID = Shader::CompileShader(GL_VERTEX_SHADER, source.VertexSource);
+		if (!source.FragmentSource.empty())
+			pending.FragmentID = Shader::CompileShader(GL_FRAGMENT_SHADER, source.FragmentSource);
+	}
+
+	for (PendingProgram& pending : m_Pending)
+	{
+		GlCall(pending.ProgramID = glCreateProgram());
+		if (pending.File->Separable) {
+			GlCall(glProgramParameteri(pending.ProgramID, GL_PROGRAM_SEPARABLE, GL_TRUE));
+		}
+		if (pending.VertexID) {
+			GlCall(glAttachShader(pending.ProgramID, pending.VertexID));
+		}
+		if (pending.FragmentID) {
+			GlCall(glAttachShader(pending.ProgramID, pending.FragmentID));
+		}
+		GlCall(glLinkProgram(pending.ProgramID));
+	}
+
+	/* Everything is in flight now.  Without the extension the first status query
+	   blocks until that program is done, so just resolve them in order. */
+	size_t remaining = m_Pending.size();
+	std::vector<bool> resolved(m_Pending.size(), !parallel);
+	if (!parallel)
+	{
+		for (PendingProgram& pending : m_Pending)
+			Resolve(pending);
+		remaining = 0;
+	}
+
+	while (remaining > 0)
+	{
+		size_t before = remaining;
+		for (size_t i = 0; i < m_Pending.size(); i++)
+		{
+			if (resolved[i])
+				continue;
+
+			int complete;
+			GlCall(glGetProgramiv(m_Pending[i].ProgramID, GL_COMPLETION_STATUS_KHR, &complete));
+			if (complete == GL_FALSE)
+				continue;
+
+			Resolve(m_Pending[i]);
+			resolved[i] = true;
+			remaining--;
+		}
+
+		if (remaining == before)
+			std::this_thread::yield();
+	}
+
+	m_Pending.clear();
+}
+
+Shader* ShaderLibrary::Get(const std::string& name, const ShaderDefines& defines)
+{
+	std::string key = ShaderPreprocessor::PermutationKey(name, defines);
+	auto it = m_Shaders.find(key);
+	if (it != m_Shaders.end())
+		return it->second.get();
+
+	/* not built yet: compile just this permutation (plus anything else still queued) */
+	Request(name, defines);
+	Build();
+
+	it = m_Shaders.find(key);
+	if (it != m_Shaders.end())
+		return it->second.get();
+
+	if (m_Failed.find(key) == m_Failed.end())
+		std::cout << "Warning:  shader '" << key << "' doesn't exist!" << std::endl;
+	return nullptr;
+}
+
+ProgramPipeline* ShaderLibrary::GetPipeline(Shader* vertexStage, Shader* fragmentStage)
+{
+	if (!vertexStage || !fragmentStage)
+		return nullptr;
+
+	std::unique_ptr<ProgramPipeline>& pipeline = m_Pipelines[std::make_pair(vertexStage, fragmentStage)];
+	if (!pipeline)
+		pipeline = std::make_unique<ProgramPipeline>(*vertexStage, *fragmentStage);
+	return pipeline.get();
+}
+
+ProgramPipeline* ShaderLibrary::GetPipeline(const std::string& vertexStage, const std::string& fragmentStage)
+{
+	return GetPipeline(Get(vertexStage), Get(fragmentStage));
+}
+
+bool ShaderLibrary::Resolve(PendingProgram& pending)
+{
+	PROFILE_FUNCTION();
+	bool spirv = pending.File->Spirv;
+	bool ok = spirv ? pending.VertexID && pending.FragmentID : pending.VertexID || pending.FragmentID;
+	if (!pending.SourceComplete)
+		ok = false;
+	else if (!ok && !spirv)
+		std::cout << "Shader error: no #shader section in " << pending.File->FilePath << std::endl;
+	if (pending.VertexID)
+		ok = Shader::CheckCompileStatus(pending.VertexID, GL_VERTEX_SHADER) && ok;
+	if (pending.FragmentID)
+		ok = Shader::CheckCompileStatus(pending.FragmentID, GL_FRAGMENT_SHADER) && ok;
+	ok = ok && Shader::CheckLinkStatus(pending.ProgramID, pending.File->FilePath);
+
+	/* glDeleteShader() silently ignores 0 */
+	GlCall(glDeleteShader(pending.VertexID));
+	GlCall(glDeleteShader(pending.FragmentID));
+
+	if (!ok)
+	{
+		GlCall(glDeleteProgram(pending.ProgramID));
+		m_Failed.insert(pending.Key);
+		return false;
+	}
+
+	m_Shaders[pending.Key] = std::make_unique<Shader>(pending.File->FilePath, pending.ProgramID);
+	return true;
+}
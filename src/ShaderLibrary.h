@@ -0,0 +1,83 @@
+#pragma once
+#include "ProgramPipeline.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Owns every Shader used by the application and builds them as one batch.
+ * Build() queues the compiles and links of all registered programs before it
+ * asks the driver for a single status, so drivers with a compile thread pool
+ * (GL_KHR_parallel_shader_compile) can work on all of them at once.
+ *
+ * A shader file can be built in many permutations, one per set of injected
+ * #defines.  Only permutations that are requested (or fetched) get compiled;
+ * each is cached under ShaderPreprocessor::PermutationKey().
+ *
+ * Stage files hold a single #shader section and are linked as separable
+ * programs.  GetPipeline() combines a vertex and a fragment stage in a cached
+ * program pipeline, so new combinations need no link at all.
+ *
+ * Precompiled SPIR-V modules skip the driver's GLSL front end.  They are not
+ * preprocessed; variants come from specialization constants instead.
+ */
+class ShaderLibrary
+{
+private:
+	struct ShaderFile
+	{
+		std::string FilePath;        // the GLSL file, or the vertex module for SPIR-V
+		bool Separable = false;
+		bool Spirv = false;
+		std::string FragmentModule;
+		SpecializationConstants VertexConstants;    // each module may only be given the constant_ids it declares
+		SpecializationConstants FragmentConstants;
+	};
+
+	struct PendingProgram
+	{
+		std::string Key;
+		const ShaderFile* File = nullptr;  // m_Files is node based, so this stays valid
+		ShaderDefines Defines;
+		unsigned int VertexID = 0;
+		unsigned int FragmentID = 0;
+		unsigned int ProgramID = 0;
+		bool SourceComplete = true;        // false if ParseShader() already reported a missing file or #include
+	};
+
+	std::unordered_map<std::string, ShaderFile> m_Files;
+	std::vector<PendingProgram> m_Pending;
+	std::unordered_map<std::string, std::unique_ptr<Shader>> m_Shaders;
+	std::unordered_set<std::string> m_Failed;  // not retried, so a broken permutation is only reported once
+	std::map<std::pair<const Shader*, const Shader*>, std::unique_ptr<ProgramPipeline>> m_Pipelines;
+
+public:
+	ShaderLibrary();
+	~ShaderLibrary();
+
+	/* registers a shader file and queues its default (no defines) permutation */
+	void Add(const std::string& name, const std::string& filepath);
+	/* registers a single-stage file that is linked as a separable program */
+	void AddStage(const std::string& name, const std::string& filepath);
+	/* registers a program built from SPIR-V vertex and fragment modules (GL 4.6 or ARB_gl_spirv);
+	   each module gets its own constants, since specializing an undeclared constant_id fails */
+	void AddSpirv(const std::string& name, const std::string& vertexModule, const std::string& fragmentModule,
+		const SpecializationConstants& vertexConstants = SpecializationConstants(),
+		const SpecializationConstants& fragmentConstants = SpecializationConstants());
+	/* queues a permutation so it is compiled with the next Build() */
+	void Request(const std::string& name, const ShaderDefines& defines);
+	void Build();
+	/* a permutation that was never requested is compiled on the spot */
+	Shader* Get(const std::string& name, const ShaderDefines& defines = ShaderDefines());
+	/* combines two separable stages; each pair is created once and cached */
+	ProgramPipeline* GetPipeline(Shader* vertexStage, Shader* fragmentStage);
+	ProgramPipeline* GetPipeline(const std::string& vertexStage, const std::string& fragmentStage);
+private:
+	bool Resolve(PendingProgram& pending);
+};
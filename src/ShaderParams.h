@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+
+/*
+ * CPU-side mirrors of the parameter blocks declared in res/shaders/Params.glsl.
+ * Their layout is fixed at compile time to match std140 (uniform blocks) and
+ * std430 (storage blocks); the static_asserts below fail the build if a member
+ * is added without the padding the GLSL rules require.
+ */
+
+/* binding points shared by the C++ side and every shader */
+enum ParamBinding
+{
+	FRAME_PARAMS_BINDING = 0,
+	VIEW_PARAMS_BINDING = 1,
+	OBJECT_PARAMS_BINDING = 2
+};
+
+/* std140 uniform block FrameParams: changes every frame */
+struct FrameParams
+{
+	float Time;
+	float DeltaTime;
+	unsigned int FrameIndex;
+	float Pad0;
+};
+
+/* std140 uniform block ViewParams: changes when the view or window does */
+struct ViewParams
+{
+	float ViewProjection[16];  // column-major mat4
+	float Viewport[4];         // x, y, width, height
+};
+
+/* std430 element of the ObjectParams storage block, indexed by gl_BaseInstance */
+struct ObjectParams
+{
+	float Color[4];
+};
+
+static_assert(sizeof(FrameParams) == 16, "std140: FrameParams must be padded to a vec4");
+static_assert(offsetof(ViewParams, Viewport) == 64, "std140: mat4 occupies 4 vec4 columns");
+static_assert(sizeof(ViewParams) % 16 == 0, "std140: block size is a multiple of a vec4");
+static_assert(sizeof(ObjectParams) % 16 == 0, "std430: array stride of a struct with a vec4 is 16");
@@ -0,0 +1,160 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <iostream>
+
+static std::string directoryOf(const std::string& filepath)
+{
+	size_t slash = filepath.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : filepath.substr(0, slash + 1);
+}
+
+const MappedFile* ShaderSourceStorage::Map(const std::string& filepath)
+{
+	for (const auto& mapped : Files)
+		if (mapped.first == filepath)
+			return mapped.second.get();
+
+	std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>(filepath);
+	if (!file->IsOpen())
+		return nullptr;
+
+	Files.emplace_back(filepath, std::move(file));
+	return Files.back().second.get();
+}
+
+bool ShaderPreprocessor::Process(std::string_view source, const std::string& filepath,
+	const ShaderDefines& defines, ShaderSourceStorage& storage, ShaderSourcePieces& out)
+{
+	std::vector<std::string> includeStack;
+	includeStack.push_back(filepath);
+
+	out.clear();
+	bool ok = ExpandIncludes(source, filepath, includeStack, storage, out);
+	InjectDefines(out, defines, storage);
+	return ok;
+}
+
+std::string ShaderPreprocessor::PermutationKey(const std::string& name, const ShaderDefines& defines)
+{
+	std::string key = name;
+	char separator = '[';
+	for (const auto& define : defines)
+	{
+		key += separator;
+		key += define.first;
+		if (!define.second.empty())
+			key += '=' + define.second;
+		separator = ',';
+	}
+	if (!defines.empty())
+		key += ']';
+	return key;
+}
+
+bool ShaderPreprocessor::ExpandIncludes(std::string_view source, const std::string& filepath,
+	std::vector<std::string>& includeStack, ShaderSourceStorage& storage, ShaderSourcePieces& out)
+{
+	/* text between #include lines is passed through as one view; only the directives split it */
+	size_t runStart = 0;
+	bool ok = true;
+	for (size_t directive = source.find("#include"); directive != std::string_view::npos; directive = source.find("#include", directive + 1))
+	{
+		size_t lineStart = source.rfind('\n', directive);
+		lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+		if (source.substr(lineStart, directive - lineStart).find_first_not_of(" \t") != std::string_view::npos)
+			continue; // not at the start of the line, e.g. commented out
+
+		size_t lineEnd = source.find('\n', directive);
+		lineEnd = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+		std::string_view line = source.substr(directive, lineEnd - directive);
+		int lineNumber = 1 + (int)std::count(source.begin(), source.begin() + lineStart, '\n');
+
+		if (lineStart > runStart)
+			out.push_back(source.substr(runStart, lineStart - runStart));
+		runStart = lineEnd;
+
+		size_t open = line.find('"');
+		size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+		if (close == std::string_view::npos)
+		{
+			std::cout << "Shader error: malformed #include in " << filepath << ":" << lineNumber << std::endl;
+			ok = false;
+			continue;
+		}
+
+		std::string includePath = directoryOf(filepath) + std::string(line.substr(open + 1, close - open - 1));
+		if (std::find(includeStack.begin(), includeStack.end(), includePath) != includeStack.end())
+		{
+			std::cout << "Shader error: recursive #include of " << includePath << " in " << filepath << std::endl;
+			ok = false;
+			continue;
+		}
+
+		const MappedFile* file = storage.Map(includePath);
+		if (!file)
+		{
+			std::cout << "Shader error: cannot open #include " << includePath << " in " << filepath << std::endl;
+			ok = false;
+			continue;
+		}
+
+		includeStack.push_back(includePath);
+		out.push_back("#line 1\n");
+		ok = ExpandIncludes(file->View(), includePath, includeStack, storage, out) && ok;
+		includeStack.pop_back();
+
+		/* keep compiler messages pointing at the right line of the including file */
+		storage.Generated.push_back("\n#line " + std::to_string(lineNumber + 1) + '\n');
+		out.push_back(storage.Generated.back());
+	}
+
+	if (source.size() > runStart)
+		out.push_back(source.substr(runStart));
+	return ok;
+}
+
+void ShaderPreprocessor::InjectDefines(ShaderSourcePieces& pieces, const ShaderDefines& defines, ShaderSourceStorage& storage)
+{
+	if (defines.empty())
+		return;
+
+	/* GLSL requires #version to come first, so the defines go right behind it */
+	size_t piece = 0;
+	size_t insertAt = 0;
+	int versionLine = 0;
+	for (size_t i = 0; i < pieces.size(); i++)
+	{
+		size_t version = pieces[i].find("#version");
+		if (version == std::string_view::npos)
+			continue;
+
+		size_t end = pieces[i].find('\n', version);
+		piece = i;
+		insertAt = end == std::string_view::npos ? pieces[i].size() : end + 1;
+		for (size_t j = 0; j < i; j++)
+			versionLine += (int)std::count(pieces[j].begin(), pieces[j].end(), '\n');
+		versionLine += (int)std::count(pieces[i].begin(), pieces[i].begin() + insertAt, '\n');
+		break;
+	}
+
+	std::string block;
+	for (const auto& define : defines)
+		block += "#define " + define.first + (define.second.empty() ? "" : " " + define.second) + '\n';
+	block += "#line " + std::to_string(versionLine + 1) + '\n';
+	storage.Generated.push_back(block);
+
+	if (pieces.empty())
+	{
+		pieces.push_back(storage.Generated.back());
+		return;
+	}
+
+	/* split the piece holding #version around the insertion point */
+	std::string_view head = pieces[piece].substr(0, insertAt);
+	std::string_view tail = pieces[piece].substr(insertAt);
+	pieces[piece] = head;
+	pieces.insert(pieces.begin() + piece + 1, storage.Generated.back());
+	if (!tail.empty())
+		pieces.insert(pieces.begin() + piece + 2, tail);
+}
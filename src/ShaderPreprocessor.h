@@ -0,0 +1,42 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* #define name -> value injected into every stage; ordered so equal sets give equal keys */
+typedef std::map<std::string, std::string> ShaderDefines;
+
+/* A stage's source as consecutive pieces; glShaderSource() takes them as-is, so nothing is concatenated. */
+typedef std::vector<std::string_view> ShaderSourcePieces;
+
+/* Owns the memory that ShaderSourcePieces point into: the mapped files and the few generated lines. */
+struct ShaderSourceStorage
+{
+	std::vector<std::pair<std::string, std::unique_ptr<MappedFile>>> Files;  // path -> mapping, each file mapped once
+	std::deque<std::string> Generated;  // a deque never moves its elements, so views into them stay valid
+
+	const MappedFile* Map(const std::string& filepath);
+};
+
+/*
+ * Expands `#include "file"` directives (relative to the including file) and injects
+ * a set of #defines right after the `#version` line of a stage.  Each distinct define
+ * set is a permutation of the shader; PermutationKey() names it for caching.
+ */
+class ShaderPreprocessor
+{
+public:
+	/* false if an #include could not be expanded; the error is logged and out keeps the text around it */
+	static bool Process(std::string_view source, const std::string& filepath,
+		const ShaderDefines& defines, ShaderSourceStorage& storage, ShaderSourcePieces& out);
+	static std::string PermutationKey(const std::string& name, const ShaderDefines& defines);
+private:
+	static bool ExpandIncludes(std::string_view source, const std::string& filepath,
+		std::vector<std::string>& includeStack, ShaderSourceStorage& storage, ShaderSourcePieces& out);
+	static void InjectDefines(ShaderSourcePieces& pieces, const ShaderDefines& defines, ShaderSourceStorage& storage);
+};
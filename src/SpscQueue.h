@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+/*
+ * Bounded single-producer, single-consumer queue.  The producer only writes the
+ * tail and the consumer only writes the head, each on its own cache line, so a
+ * push or pop is one acquire load and one release store; neither side takes a
+ * lock while the other is busy.
+ *
+ * Pop() sleeps while the queue is empty.  A push takes the lock only when the
+ * consumer is asleep, which is when the consumer has nothing better to do.
+ * CAPACITY must be a power of two.
+ */
+template<typename T, unsigned int CAPACITY>
+class SpscQueue
+{
+private:
+	static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+	alignas(64) std::atomic<unsigned int> m_Head;   // next item to pop; counts up, wraps with unsigned arithmetic
+	alignas(64) std::atomic<unsigned int> m_Tail;   // next slot to push
+	alignas(64) std::atomic<bool> m_ConsumerWaiting;
+	T m_Items[CAPACITY];
+	std::mutex m_WaitMutex;
+	std::condition_variable m_Wake;
+public:
+	SpscQueue()
+		: m_Head(0), m_Tail(0), m_ConsumerWaiting(false)
+	{
+	}
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	/* producer only; false if the queue is full */
+	bool TryPush(const T& item)
+	{
+		unsigned int tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_Head.load(std::memory_order_acquire) == CAPACITY)
+			return false;
+		m_Items[tail & (CAPACITY - 1)] = item;
+		m_Tail.store(tail + 1, std::memory_order_release);
+
+		/* pairs with the fence in Pop(): either the consumer sees the item or this sees it waiting */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_ConsumerWaiting.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> lock(m_WaitMutex);
+			m_Wake.notify_one();
+		}
+		return true;
+	}
+
+	/* consumer only; false if the queue is empty */
+	bool TryPop(T& item)
+	{
+		unsigned int head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return false;
+		item = m_Items[head & (CAPACITY - 1)];
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* consumer only; waits for an item */
+	void Pop(T& item)
+	{
+		if (TryPop(item))
+			return;
+		std::unique_lock<std::mutex> lock(m_WaitMutex);
+		m_ConsumerWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		m_Wake.wait(lock, [&] { return TryPop(item); });
+		m_ConsumerWaiting.store(false, std::memory_order_relaxed);
+	}
+
+	/* exact on the producer's side; elsewhere a snapshot */
+	bool Full() const
+	{
+		return m_Tail.load(std::memory_order_relaxed) - m_Head.load(std::memory_order_acquire) == CAPACITY;
+	}
+};
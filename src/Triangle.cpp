@@ -10,8 +10,9 @@ Triangle::~Triangle()
 {
 }
 
-void Triangle::Draw()
+void Triangle::Draw(unsigned int object)
 {
 	GlCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0));
-	GlCall(glDrawElements(GL_TRIANGLES, m_Vbuffer.Count() / 3, GL_UNSIGNED_INT, nullptr));
-}
\ No newline at end of file
+	GlCall(glDrawElementsInstancedBaseInstance(GL_TRIANGLES, m_Vbuffer.Count() / 3, GL_UNSIGNED_INT, nullptr, 1, object));
+	CountDraw(m_Vbuffer.Count() / 3);
+}
@@ -11,5 +11,6 @@ private:
 public:
 	Triangle(VertexBuffer& vBuffer, IndexBuffer& iBuffer);
 	~Triangle();
-	void Draw();
+	/* object is the ObjectParams index the shader reads through gl_BaseInstance */
+	void Draw(unsigned int object);
 };
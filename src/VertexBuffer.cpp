@@ -1,11 +1,26 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
 VertexBuffer::VertexBuffer(const float* data, int count) : v_Count(count)
 {
+	PROFILE_FUNCTION();
 	GlCall(glGenBuffers(1, &v_RendererID));
 	GlCall(glBindBuffer(GL_ARRAY_BUFFER, v_RendererID));
 	GlCall(glBufferData(GL_ARRAY_BUFFER, v_Count * sizeof(float), data, GL_STATIC_DRAW));
+	CountUpload(v_Count * sizeof(float));
+}
+
+void VertexBuffer::Bind() const
+{
+	GlCall(glBindBuffer(GL_ARRAY_BUFFER, v_RendererID));
+}
+
+void VertexBuffer::Update(int first, const float* data, int count)
+{
+	ASSERT(first >= 0 && first + count <= v_Count);
+	GlCall(glNamedBufferSubData(v_RendererID, first * sizeof(float), count * sizeof(float), data));
+	CountUpload(count * sizeof(float));
 }
 
 VertexBuffer::~VertexBuffer()
@@ -10,5 +10,10 @@ private:
 public:
 	VertexBuffer(const float* data, int count);
 	~VertexBuffer();
+	/* the draw wrappers take their attribute pointers from the bound GL_ARRAY_BUFFER */
+	void Bind() const;
+	/* overwrites count floats starting at float offset first */
+	void Update(int first, const float* data, int count);
 	int Count() const { return v_Count; }
+	unsigned int GetRendererID() const { return v_RendererID; }
 };